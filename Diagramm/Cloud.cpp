@@ -7,6 +7,7 @@ constexpr char* writeKey = "4HF52H0KRO52LUML";
 constexpr char* readKey = "UJDW2P7XH3SP2RV2";
 
 WiFiClient client;
+static ThingSpeakClass thingspeak; //Eigene Instanz für den Kanal der Messwerte, andere Kanäle bekommen ihre eigene
 
 void init_wifi() {
     Serial.println("Verbinde mit WLan");
@@ -19,15 +20,182 @@ void init_wifi() {
 }
 
 void init_cloud() {
-    ThingSpeak.begin(client);
+    thingspeak.begin(client);
+    thingspeak.setFieldPrecision(1, 2); //Temperatur in °C
+    thingspeak.setFieldPrecision(2, 2); //Luftdruck in hPa
+    thingspeak.setFieldPrecision(3, 1); //Feuchtigkeit in %
+    configTime(0, 0, "pool.ntp.org", "time.nist.gov"); //Für die Zeitstempel der Warteschlange, in UTC
 }
 
-namespace cl {
-    void send(Record values) {
-        ThingSpeak.setField(1, values.temp);
-        ThingSpeak.setField(2, values.press);
-        ThingSpeak.setField(3, values.humid);
+cl::Entry cl::queue[queuesize];
+uint8_t cl::first = 0;
+uint8_t cl::count = 0;
+uint8_t cl::sending = 0;
+unsigned long cl::last = 0;
+unsigned long cl::backoff = 0; //Der erste Versuch sofort
+unsigned long cl::jitter = 0;
+Record cl::reference = {NAN, NAN, NAN}; //Die erste Messung liegt nie in der Totzone
+unsigned long cl::referenced = 0;
+Record cl::previous = {NAN, NAN, NAN};
+unsigned long cl::measured = 0;
+float cl::activity = 0;
+unsigned long cl::started = 0;
+unsigned long cl::rtt = 0;
+float cl::errors = 0;
+unsigned long cl::sent_count = 0;
+unsigned long cl::suppressed_count = 0;
 
-        ThingSpeak.writeFields(channelID, writeKey);
+cl::Entry& cl::at(int i) {
+    return queue[(first + i) % queuesize];
+}
+
+bool cl::changed(const Record& values) { //NaN gilt als Änderung
+    return !(fabs(values.temp - reference.temp) <= deadband.temp
+             && fabs(values.press - reference.press) <= deadband.press
+             && fabs(values.humid - reference.humid) <= deadband.humid);
+}
+
+void cl::send(Record values) {
+    unsigned long now = millis();
+
+    //Größte Änderung seit der letzten Messung, in Totzonen je Minute
+    float change = fmax(fmax(fabs(values.temp - previous.temp) / deadband.temp,
+                             fabs(values.press - previous.press) / deadband.press),
+                        fabs(values.humid - previous.humid) / deadband.humid);
+    if (!isnan(change) && now != measured)
+        activity = activity * 0.75f + change * 60000.0f / (now - measured) * 0.25f;
+    previous = values;
+    measured = now;
+
+    if (!changed(values) && now - referenced < heartbeat) {
+        ++suppressed_count;
+        return;
+    }
+    reference = values;
+    referenced = now;
+    ++sent_count;
+
+    if (count == queuesize) //Lieber die alten Werte gröber als die neuen gar nicht
+        downsample();
+    at(count) = {values, now, 1};
+    ++count;
+}
+
+unsigned long cl::interval() {
+    if (activity * max_interval <= 60000.0f) //Auch über die längste Zeit weniger als eine Totzone
+        return max_interval;
+    unsigned long ms = 60000.0f / activity;
+    return ms < min_backoff ? min_backoff : ms; //Öfter nimmt ThingSpeak nicht an
+}
+
+unsigned long cl::pause() {
+    float ms = interval(); //Bei ruhigen Werten sammeln sich mehrere Einträge für eine Anfrage
+    if (rtt > slow_rtt) //Langsame Verbindung: seltener, dafür größere Stapel
+        ms = ms * rtt / slow_rtt;
+    ms *= 1 + 3 * errors; //Wackelige Verbindung: bis zu viermal so lange warten
+    return ms > max_backoff ? max_backoff : (unsigned long)ms;
+}
+
+unsigned long cl::sent() {
+    return sent_count;
+}
+
+unsigned long cl::suppressed() {
+    return suppressed_count;
+}
+
+cl::Entry cl::merge(const Entry& a, const Entry& b) {
+    float wa = a.weight, wb = b.weight;
+    float w = wa + wb;
+    return {
+        {
+            (a.values.temp * wa + b.values.temp * wb) / w,
+            (a.values.press * wa + b.values.press * wb) / w,
+            (a.values.humid * wa + b.values.humid * wb) / w
+        },
+        a.time + (unsigned long)((b.time - a.time) * wb / w), //Gewichtete Mitte
+        uint8_t(a.weight + b.weight > 255 ? 255 : a.weight + b.weight)
+    };
+}
+
+void cl::downsample() { //Der Stapel, der gerade hochgeladen wird, bleibt wie er ist
+    int older = (count - sending) / 2 & ~1; //Gerade Anzahl der älteren Einträge, die paarweise zusammengefasst werden
+    int n = sending; //Einträge danach, nie hinter dem gelesenen Index
+    for (int i = sending; i < sending + older; i += 2)
+        at(n++) = merge(at(i), at(i + 1));
+    for (int i = sending + older; i < count; ++i)
+        at(n++) = at(i);
+    count = n;
+}
+
+void cl::retry() {
+    backoff = backoff < min_backoff ? min_backoff : backoff * 2;
+    if (backoff > max_backoff)
+        backoff = max_backoff;
+    jitter = random(backoff / 4); //Damit nicht alle Stationen zugleich wiederkommen, bleibt aus dem Verdoppeln heraus
+}
+
+cl::Upload cl::upload() {
+    time_t now = time(nullptr);
+    if (now < 1600000000) //Noch keine Uhrzeit vom NTP-Server, ohne sie stimmen die Zeitstempel nicht
+        return NoClock;
+
+    last = millis(); //Erst ab hier ein Versuch
+    unsigned long ms = last;
+    thingspeak.clearBulk();
+    int added = 0;
+    while (added < batch && added < count) {
+        const Entry& e = at(added);
+        time_t t = now - (ms - e.time) / 1000;
+        char created[21]; //2021-04-01T12:00:00Z
+        strftime(created, sizeof(created), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+
+        thingspeak.setField(1, e.values.temp);
+        thingspeak.setField(2, e.values.press);
+        thingspeak.setField(3, e.values.humid);
+        if (thingspeak.addBulkEntry(String(created)) != TS_OK_SUCCESS)
+            break; //Puffer voll, der Rest kommt beim nächsten Mal
+        ++added;
+    }
+
+    started = millis(); //Vor dem Losschicken, die Antwortzeit zählt ab hier
+    if (thingspeak.beginWriteBulk(channelID, writeKey, done) != TS_OK_SUCCESS)
+        return Failed;
+
+    sending = added;
+    return Sent;
+}
+
+void cl::account(bool ok) {
+    errors = errors * 0.75f + (ok ? 0 : 0.25f);
+}
+
+void cl::done(int status, const char*) {
+    last = millis(); //Wartezeiten ab der Antwort, so zählt auch ThingSpeak die Ratenbegrenzung
+    unsigned long took = last - started;
+    rtt = rtt == 0 ? took : (rtt * 3 + took) / 4;
+    account(status == TS_OK_SUCCESS);
+
+    if (status == TS_OK_SUCCESS) {
+        //Erst nach dem Erfolg aus der Warteschlange nehmen
+        first = (first + sending) % queuesize;
+        count -= sending;
+        backoff = pause(); //Nie unter min_backoff, der Ratenbegrenzung
+        jitter = 0;
+    } else
+        retry();
+    sending = 0;
+}
+
+void cl::work() {
+    if (thingspeak.poll()) //Der Stapel ist noch unterwegs
+        return;
+    if (count == 0 || millis() - last < backoff + jitter)
+        return;
+
+    //Ohne Uhrzeit liegt es nicht an der Verbindung: weder Fehler noch längere Wartezeit, beim nächsten Aufruf wieder
+    if (upload() == Failed) { //Nicht einmal losgeschickt, zählt genauso als Fehler
+        account(false);
+        retry();
     }
 }
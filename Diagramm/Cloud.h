@@ -10,8 +10,58 @@ void init_wifi();
 
 void init_cloud();
 
-namespace cl { //Cloud
-    void send(Record values);
-}
+class cl { //Cloud
+public:
+    static constexpr uint8_t queuesize = 64; //Einträge, die auf das Hochladen warten können
+    static constexpr uint8_t batch = 16; //Einträge je Anfrage, alle mit Zeitstempel
+    static constexpr unsigned long min_backoff = 15000; //ms, Ratenbegrenzung von ThingSpeak
+    static constexpr unsigned long max_backoff = 600000; //ms, auch bei langer Störung alle 10 Minuten versuchen
+    static constexpr Record deadband = {0.2, 0.5, 1.0}; //°C, hPa, %: kleinere Änderungen sind Rauschen des BME280
+    static constexpr unsigned long heartbeat = 900000; //ms, spätestens dann wird auch ohne Änderung gesendet
+    static constexpr unsigned long max_interval = 300000; //ms, längster Abstand zwischen Messungen und Uploads bei ruhigem Wetter
+    static constexpr unsigned long slow_rtt = 2000; //ms, langsamere Antworten strecken die Pausen zwischen den Uploads
+
+    static void send(Record values); //reiht die Werte mit dem jetzigen Zeitpunkt ein, wenn sich einer über die Totzone hinaus geändert hat
+    static unsigned long sent(); //Anzahl der eingereihten Messungen
+    static unsigned long suppressed(); //Anzahl der Messungen, die in der Totzone lagen und nicht gesendet wurden
+    static unsigned long interval(); //ms bis zur nächsten Messung für send(): etwa die Zeit, in der sich ein Wert um eine Totzone ändert
+    static void work(); //lädt die ältesten Einträge hoch, sobald die Wartezeit um ist, aus loop() aufrufen, wartet nie auf den Server
+private:
+    enum Upload : uint8_t {Sent, Failed, NoClock}; //Ergebnis von upload()
+
+    struct Entry {
+        Record values;
+        unsigned long time; //millis() bei der Messung
+        uint8_t weight; //Anzahl zusammengefasster Messungen
+    };
+
+    static Entry& at(int i); //0 ist der älteste Eintrag
+    static bool changed(const Record& values); //Mindestens ein Wert außerhalb der Totzone um den zuletzt eingereihten
+    static Entry merge(const Entry& a, const Entry& b); //Mittel nach Gewicht
+    static void downsample(); //fasst die ältere Hälfte paarweise zusammen, wenn die Warteschlange voll ist
+    static Upload upload(); //schickt einen Stapel als Bulk-Update los, NoClock ist noch kein Versuch
+    static void done(int status, const char* response); //Antwort von ThingSpeak auf den Stapel
+    static void retry(); //Wartezeit verdoppeln, Zufall neu auswürfeln
+    static void account(bool ok); //Ergebnis eines Versuchs in 'errors' einrechnen
+    static unsigned long pause(); //Wartezeit nach einem erfolgreichen Upload, nach Änderungsrate und Verbindung
+
+    static Entry queue[queuesize]; //Ringpuffer
+    static uint8_t first; //Index des ältesten Eintrags
+    static uint8_t count; //Anzahl der wartenden Einträge
+    static uint8_t sending; //Einträge am Anfang, die gerade hochgeladen werden
+    static unsigned long last; //Zeitpunkt des letzten Versuchs
+    static unsigned long backoff; //Wartezeit bis zum nächsten Versuch, ohne Zufall
+    static unsigned long jitter; //Zufälliger Zuschlag auf backoff nach einem Fehler
+    static Record reference; //Zuletzt eingereihte Werte, Mitte der Totzone
+    static unsigned long referenced; //Zeitpunkt davon
+    static Record previous; //Letzte Messung, für die Änderungsrate
+    static unsigned long measured; //Zeitpunkt davon
+    static float activity; //Gleitendes Mittel der Änderung in Totzonen je Minute
+    static unsigned long started; //Beginn des laufenden Uploads
+    static unsigned long rtt; //Gleitendes Mittel der Antwortzeit
+    static float errors; //Gleitender Anteil der fehlgeschlagenen Uploads
+    static unsigned long sent_count;
+    static unsigned long suppressed_count;
+};
 
 #endif //_CLOUD_H
@@ -2,13 +2,14 @@
 #include "Graphics.h"
 #include "Display.h"
 #include "Cloud.h"
+#include "Snapshot.h"
 #include "Range.h"
 #include <PolledTimeout.h>
 
 using namespace std;
 
 using esp8266::polledTimeout::periodicFastMs;
-periodicFastMs upload(20000);
+periodicFastMs upload(cl::min_backoff); //Die erste Messung bald, danach passt sich der Abstand in cl::interval() der Änderungsrate an
 periodicFastMs actualize(1000);
 
 void setup() {
@@ -16,7 +17,9 @@ void setup() {
   init_wifi();
   init_cloud();
   init_tft();
+  init_touch();
   init_bme();
+  init_snapshot();
 }
 
 void loop() {
@@ -32,11 +35,17 @@ void loop() {
   }
   */
   if (upload) {
-    cl::send(rc::average());
+    cl::send(rc::average()); //Nur einreihen, hochgeladen wird in cl::work()
+    upload.reset(cl::interval());
   }
+  cl::work();
   if (actualize) {
     rc::measure();
     ds::refresh();
   }
+  if (sn::busy())
+    sn::work(); //Solange die Aufnahme läuft, bleibt das Bild stehen
+  else
+    ds::work(); //Zeichnet höchstens ds::budget ms am Stück, damit Berührungen nicht verloren gehen
   ts::check();
 }
@@ -1,28 +1,112 @@
 #include "Display.h"
 #include "Record.h"
 #include "Graphics.h"
+#include "Glyphs.h"
 #include "Plot.h"
-#include "MultiGradient.h"
+#include "GradientTable.h"
+#include "Snapshot.h"
+#include "Cloud.h"
 
 using namespace std;
 
-ts::Selection ts::last;
+#ifndef TOUCH_IRQ
+#define TOUCH_IRQ 5 //PENIRQ des XPT2046, GPIO5 (D1), kann im User_Setup von TFT_eSPI überschrieben werden
+#endif
 
-void ts::check() {
-    uint16_t x = 320, y = 240; //Liegt im Nirvana
-    tft.getTouch(&x,&y);
-    Selection now;
-    if (x < 40) { //Überprüfen, ob der Punkt auf den Pfeilen liegt
-        if (y < 40)
-            now = Prev;
-        else if (y > 200)
-            now = Next;
+#ifndef REPORT_PORT
+#define REPORT_PORT SNAPSHOT_PORT //Serial ist nicht gestartet, RX/TX sind der I2C-Bus
+#endif
+
+ts::Selection ts::last = None;
+volatile bool ts::pending = false;
+volatile unsigned long ts::edge = 0;
+bool ts::pressed = false;
+bool ts::held = false;
+unsigned long ts::since = 0;
+uint16_t ts::x = 320, ts::y = 240; //Liegt im Nirvana
+ts::Event ts::queue[ts::queuesize];
+uint8_t ts::head = 0, ts::count = 0;
+
+void init_touch() {
+    Serial.println("Initialisiere Touchscreen");
+    pinMode(TOUCH_IRQ, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(TOUCH_IRQ), ts::isr, CHANGE);
+}
+
+void IRAM_ATTR ts::isr() {
+    edge = millis();
+    pending = true;
+}
+
+void ts::update() {
+    unsigned long now = millis();
+
+    //Erst wenn PENIRQ 'debounce' ms ruhig war, zählt der Pegel
+    if (pending && now - edge >= debounce) {
+        pending = false;
+        bool down = digitalRead(TOUCH_IRQ) == LOW;
+        if (down && !pressed) {
+            x = 320, y = 240;
+            tft.getTouch(&x, &y); //Nur hier wird der Controller über SPI gelesen
+            pressed = true;
+            held = false;
+            since = now;
+            push(Press);
+        } else if (!down && pressed) {
+            pressed = false;
+            push(Release);
+        }
     }
 
-    if (last != now) //Wenn der Fingerdruck sich vom Display löst
-        change(last);
-    
-    last = now;
+    if (pressed && !held && now - since >= long_press) {
+        held = true;
+        push(LongPress);
+    }
+}
+
+void ts::push(Type type) {
+    if (count == queuesize) { //Ältestes Ereignis verwerfen
+        head = (head + 1) % queuesize;
+        --count;
+    }
+    queue[(head + count) % queuesize] = {type, x, y};
+    ++count;
+}
+
+bool ts::pop(Event& e) {
+    if (count == 0)
+        return false;
+    e = queue[head];
+    head = (head + 1) % queuesize;
+    --count;
+    return true;
+}
+
+void ts::check() {
+    if (!pending && !pressed) //Ohne Berührung kostet check() nichts
+        return;
+    update();
+
+    Event e;
+    while (pop(e)) {
+        if (e.type == Press) {
+            last = None;
+            if (!ds::wake()) //Die erste Berührung weckt nur auf
+                continue;
+            if (e.x < 40) { //Überprüfen, ob der Punkt auf den Pfeilen liegt
+                if (e.y < 40)
+                    last = Prev;
+                else if (e.y > 200)
+                    last = Next;
+            }
+        } else if (e.type == Release) { //Wenn der Fingerdruck sich vom Display löst
+            change(last);
+            last = None;
+        } else if (e.type == LongPress) { //Langer Druck: Bildschirm über SNAPSHOT_PORT schicken
+            last = None; //kein Seitenwechsel beim Loslassen
+            sn::start();
+        }
+    }
 }
 
 void ts::change(Selection s) {
@@ -35,31 +119,154 @@ void ts::change(Selection s) {
 void ds::next() {
     if (++curr >= displays.size())
         curr = 0;
-    tft.fillScreen(TFT_BLACK);
+    clear = true; //Eine halb gezeichnete Anzeige wird verworfen
     refresh();
 }
 
 void ds::prev() {
     if (--curr < 0)
         curr = displays.size() - 1;
-    tft.fillScreen(TFT_BLACK);
+    clear = true;
     refresh();
 }
 
 void ds::refresh() {
-    gx::drawButtons();
-    displays[curr]();
+    unsigned long now = millis();
+    report(now);
+
+    if (!asleep && now - touched >= idle_after) { //Niemand schaut hin
+        asleep = true;
+        beat = now;
+        gx::backlight(dim);
+    }
+    if (asleep && now - beat < heartbeat) { //Das alte Bild bleibt stehen
+        ++skipped;
+        return;
+    }
+    beat = now;
+    step = 0;
 }
 
-int ds::curr = 0;
+bool ds::wake() {
+    touched = millis();
+    if (!asleep)
+        return true;
 
-void overview();
-void history();
+    asleep = false;
+    gx::backlight(bright); //Das letzte Bild steht noch, also sofort wieder da
+    refresh();
+    return false;
+}
 
-array<function<void()>, 2> ds::displays = {
-    overview,
-    history
-};
+void ds::report(unsigned long now) {
+    if (now - hour < 3600000UL)
+        return;
+    if (sn::busy()) //Nicht mitten in eine Aufnahme schreiben, beim nächsten refresh() noch einmal
+        return;
+
+    //Ausgelassene Bilder mal der mittleren Dauer eines gezeichneten Bilds
+    unsigned long saved = frames ? uint64_t(spent) * skipped / frames / 1000 : 0;
+    REPORT_PORT.print("Ruhezustand: "); REPORT_PORT.print(skipped); REPORT_PORT.print(" Bilder, ");
+    REPORT_PORT.print(saved); REPORT_PORT.println(" ms Rechenzeit in der letzten Stunde gespart");
+
+    //Je Bild: Dauer und SPI-Transaktionen, ohne gx::Batch wäre es eine je Zeichenbefehl
+    if (frames) {
+        REPORT_PORT.print("Zeichnen: "); REPORT_PORT.print(frames); REPORT_PORT.print(" Bilder, je ");
+        REPORT_PORT.print(spent / frames); REPORT_PORT.print(" us und ");
+        REPORT_PORT.print(float(gx::Batch::transactions()) / frames, 1); REPORT_PORT.println(" Transaktionen");
+    }
+    gx::Batch::reset();
+
+    //Totzone der Uploads, seit dem Start gezählt
+    REPORT_PORT.print("Cloud: "); REPORT_PORT.print(cl::sent()); REPORT_PORT.print(" Messungen eingereiht, ");
+    REPORT_PORT.print(cl::suppressed()); REPORT_PORT.println(" in der Totzone ausgelassen");
+
+    hour = now;
+    spent = 0;
+    frames = skipped = 0;
+}
+
+void ds::work() {
+    const Page& page = displays[curr];
+    if (step >= page.length) { //Schon fertig gezeichnet, Zeit für die Nachbarn
+        prerender();
+        return;
+    }
+
+    unsigned long start = millis();
+    unsigned long begin = micros();
+    gx::Batch batch; //Alle Schritte dieses Aufrufs in einer Transaktion
+    if (clear) {
+        show(curr);
+        clear = false;
+    }
+    if (step == 0)
+        gx::drawButtons();
+
+    //Mindestens ein Schritt, danach nur so viele, wie in das Zeitbudget passen
+    do {
+        page.steps[step++]();
+    } while (step < page.length && millis() - start < budget);
+
+    spent += micros() - begin;
+    if (step >= page.length)
+        ++frames;
+}
+
+void ds::show(int page) {
+    for (int i = 0; i < 2; ++i) {
+        if (imaged[i] == page) { //Vorgezeichnet: ein einziger Block über SPI
+            tft.setBitmapColor(TFT_WHITE, TFT_BLACK);
+            images[i].pushSprite(0, 0);
+            return;
+        }
+    }
+    tft.fillScreen(TFT_BLACK);
+    displays[page].chrome(tft);
+}
+
+void ds::prerender() {
+    int size = displays.size();
+    int want[2] = {(curr + 1) % size, (curr + size - 1) % size};
+    if (want[1] == want[0]) //Bei zwei Anzeigen sind beide Nachbarn dieselbe
+        want[1] = -1;
+
+    for (int i = 0; i < 2; ++i) {
+        if (imaged[i] == want[i])
+            continue;
+        if (want[i] < 0) { //Nicht mehr gebraucht
+            images[i].deleteSprite();
+            imaged[i] = -1;
+            continue;
+        }
+        if (imaged[i] < 0) {
+            if (nomem)
+                return;
+            images[i].setColorDepth(1);
+            if (!images[i].createSprite(tft.width(), tft.height())) {
+                nomem = true; //Dann eben wie früher direkt zeichnen
+                return;
+            }
+        }
+        images[i].fillSprite(TFT_BLACK);
+        displays[want[i]].chrome(images[i]); //Nur im RAM, kein SPI
+        imaged[i] = want[i];
+        return; //Ein Bild pro Aufruf, damit loop() nicht hängt
+    }
+}
+
+int ds::curr = 0;
+uint8_t ds::step = 0;
+bool ds::clear = true;
+array<TFT_eSprite, 2> ds::images = {{TFT_eSprite(&tft), TFT_eSprite(&tft)}};
+array<int, 2> ds::imaged = {{-1, -1}};
+bool ds::nomem = false;
+bool ds::asleep = false;
+unsigned long ds::touched = 0;
+unsigned long ds::beat = 0;
+unsigned long ds::hour = 0;
+unsigned long ds::spent = 0;
+uint32_t ds::frames = 0, ds::skipped = 0;
 
 //Farben für die Balken
 #define BLUE {0,0,255}
@@ -70,13 +277,41 @@ array<function<void()>, 2> ds::displays = {
 #define CYAN {0,255,255}
 #define WHITE {255,255,255}
 
-const MultiGradient TG({BLUE, GREEN, RED});
-const MultiGradient PG({MAGENTA, BLUE, GREEN, RED});
-const MultiGradient HG({WHITE, CYAN, BLUE});
+//Die Farbtabellen werden schon beim Kompilieren berechnet und liegen im Flash
+constexpr GradientTable TG PROGMEM {{BLUE, GREEN, RED}};
+constexpr GradientTable PG PROGMEM {{MAGENTA, BLUE, GREEN, RED}};
+constexpr GradientTable HG PROGMEM {{WHITE, CYAN, BLUE}};
+
+struct Gauge { //Wertebereich eines Balkens, schon in Festkomma für Länge und Farbe
+    Scale length, color;
+    constexpr Gauge(int lower, int upper) : length(bar::scale(lower, upper)), color(GradientTable::scale(lower, upper)) {}
+};
+
+constexpr Gauge TR{-20, 50};
+constexpr Gauge PR{900, 1100};
+constexpr Gauge HR{0, 100};
+
+//Beschriftung der Übersicht, steht im vorgezeichneten Hintergrund
+const char* const labels[] = {"Temperatur: ", "Luftdruck: ", "Feuchtigkeit: "};
+constexpr int top = 5;  //Abstand der ersten Zeile vom oberen Rand
+constexpr int gap = 30; //Abstand vom Ende einer Größe zur nächsten, Platz für den Balken
 
-void single_overview(const char name[], function<void(int)> unit, float aver, float last, float second, const char fill[]) {
+void overview_chrome(TFT_eSPI& g) {
+    g.setTextSize(2);
+    g.setTextColor(TFT_WHITE, TFT_BLACK);
+    for (int i = 0; i < 3; ++i) {
+        g.setCursor(gx::left_bound, top + i * (2*gl::height + gap)); //Je Größe zwei Zeilen und der Abstand
+        g.print(labels[i]);
+    }
+}
+
+//Breite der Beschriftungen in Pixeln, wie die Glyphen nur einmal gemessen
+static int16_t widths[3];
+
+void single_overview(int label, void (*unit)(int), float aver, float last, float second, const char fill[]) {
     //tx::tab() -- vorher gemacht
-      tft.print(name); tft.print(": "); tx::average(); unit(aver); tft.println(fill); //Erste Zeile mit Durchschnitt
+      tft.setCursor(tft.getCursorX() + widths[label], tft.getCursorY()); //Beschriftung steht schon da
+      tx::average(); unit(aver); tft.println(fill); //Erste Zeile mit Durchschnitt
     tx::tab();
       if (last < second) //Zweite Zeile mit Wert und Tendenz
         tx::tendencyDown();
@@ -85,33 +320,60 @@ void single_overview(const char name[], function<void(int)> unit, float aver, fl
      unit(last); tft.println(fill);
 }
 
-void overview() {
-    Record last = rc::at(rc::length() - 1);
-    Record second = rc::at(rc::length() - 2);
-    Record aver = rc::average();
+//Stand der Daten beim ersten Schritt, damit alle Stücke einer Anzeige zusammenpassen
+static Record last, second, aver;
+
+void overview_begin() {
+    last = rc::at(rc::length() - 1);
+    second = rc::at(rc::length() - 2);
+    aver = rc::average();
 
     tft.setTextSize(2);
     tft.setCursor(0,0);
+    if (!widths[0]) { //Beim ersten Bild, danach ändert sich die Schrift nicht mehr
+        for (int i = 0; i < 3; ++i)
+            widths[i] = tft.textWidth(labels[i]);
+    }
 
-    tx::tab(5);
-    single_overview("Temperatur", tx::celsius, aver.temp, last.temp, second.temp, "  ");
-    bar::draw(tft.getCursorY()+5, bar::mapx({-20, 50}, last.temp), TG.map({-20, 50}, last.temp).convert565().bytes());
+    tx::tab(top);
+}
 
-    tx::tab(30);
-    single_overview("Luftdruck", tx::hpascal, aver.press, last.press, second.press, " ");
-    bar::draw(tft.getCursorY()+5, bar::mapx({900,1100}, last.press), PG.map({900,1100}, last.press).convert565().bytes());
+void overview_temp() {
+    single_overview(0, tx::celsius, aver.temp, last.temp, second.temp, "  ");
+    bar::draw(tft.getCursorY()+5, TR.length(last.temp), TG.map(TR.color, last.temp));
+    tx::tab(gap);
+}
+
+void overview_press() {
+    single_overview(1, tx::hpascal, aver.press, last.press, second.press, " ");
+    bar::draw(tft.getCursorY()+5, PR.length(last.press), PG.map(PR.color, last.press));
+    tx::tab(gap);
+}
 
-    tx::tab(30);
-    single_overview("Feuchtigkeit", tx::percent, aver.humid, last.humid, second.humid, "  ");
-    bar::draw(tft.getCursorY()+5, bar::mapx({0,100}, last.humid), HG.map({0,100}, last.humid).convert565().bytes());
+void overview_humid() {
+    single_overview(2, tx::percent, aver.humid, last.humid, second.humid, "  ");
+    bar::draw(tft.getCursorY()+5, HR.length(last.humid), HG.map(HR.color, last.humid));
 }
 
+const ds::Step overview[] = {
+    overview_begin,
+    overview_temp,
+    overview_press,
+    overview_humid
+};
+
 //Farben für die Graphen
 #define TC TFT_RED
 #define PC TFT_GREEN
 #define HC TFT_BLUE
 
-void single_legend(const char name, function<void(int)> unit, float min, float max, const char fill[], uint16_t line_c, uint16_t text_c) {
+//Wertebereiche der Graphen, passen sich den Aufzeichnungen an
+//Startbereich wie früher fest, kleinster Bereich 2°C, 2hPa und 5%
+static gph::AutoScale TS{-20, 120, 2};
+static gph::AutoScale PS{900, 1100, 2};
+static gph::AutoScale HS{-20, 120, 5};
+
+void single_legend(const char name, void (*unit)(int), float min, float max, const char fill[], uint16_t line_c, uint16_t text_c) {
     tx::tab();
 
     tft.print(name); tft.print(": ");
@@ -121,7 +383,9 @@ void single_legend(const char name, function<void(int)> unit, float min, float m
     tft.println(fill);
 }
 
-void history() {
+static Scale x = gph::time(1); //x-Achse für alle drei Graphen, im ersten Schritt festgelegt
+
+void history_legend() {
     Record max = rc::max();
     Record min = rc::min();
     uint32_t text_c = tft.textcolor;
@@ -135,14 +399,37 @@ void history() {
 
     single_legend('F', tx::percent, min.humid, max.humid, "  ", HC, text_c);
 
-    std::vector<int> temp, press, humid;
-    for (int i = 0; i < rc::length(); ++i) { //Die drei Werte je in eine eigene Liste entzippen
-        temp.emplace_back(rc::at(i).temp);
-        press.emplace_back(rc::at(i).press);
-        humid.emplace_back(rc::at(i).humid);
-    }
-    gph::drawAxis();
-    gph::drawGraph({-20, 120}, temp, TC);
-    gph::drawGraph({-200, 1200}, press, PC);
-    gph::drawGraph({-20, 120}, humid, HC);
+    x = gph::time(rc::length());
+
+    //Die Skalen werden nur neu berechnet, wenn sich ein Bereich ändert; gezeichnet wird jedes Bild,
+    //die Kurven rücken mit jeder neuen Messung ohnehin weiter
+    TS.update(min.temp, max.temp);
+    PS.update(min.press, max.press);
+    HS.update(min.humid, max.humid);
+}
+
+//Die Graphen lesen direkt aus rc, es wird nichts umkopiert
+void history_temp() {
+    gph::drawGraph(x, TS.get(), &Record::temp, TC);
+}
+
+void history_press() {
+    gph::drawGraph(x, PS.get(), &Record::press, PC);
 }
+
+void history_humid() {
+    gph::drawGraph(x, HS.get(), &Record::humid, HC);
+}
+
+const ds::Step history[] = {
+    history_legend,
+    gph::clear, //Achsen liegen außerhalb und stehen im Hintergrund
+    history_temp,
+    history_press,
+    history_humid
+};
+
+array<ds::Page, 2> ds::displays = {{
+    {overview, sizeof(overview) / sizeof(*overview), overview_chrome},
+    {history, sizeof(history) / sizeof(*history), gph::drawAxis}
+}};
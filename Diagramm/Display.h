@@ -1,25 +1,91 @@
 #ifndef _DISPLAY_H
 #define _DISPLAY_H
 
+#include "Graphics.h"
 #include <array>
-#include <functional>
+#include <stdint.h>
+
+void init_touch();
 
 class ts { //Touchscreen
 public:
-    static void check(); //liest den Status des Touchscreens
+    static constexpr unsigned long debounce = 30;   //ms, die PENIRQ ruhig sein muss
+    static constexpr unsigned long long_press = 800; //ms bis zum langen Druck
+
+    enum Type : uint8_t {Press, Release, LongPress};
+    struct Event {
+        Type type;
+        uint16_t x, y; //Ort des Drucks, auch beim Loslassen
+    };
+
+    static void check(); //verarbeitet die seit dem letzten Aufruf angefallenen Ereignisse
 private:
+    friend void init_touch();
+
     static enum Selection {None, Prev, Next} last;
     static void change(Selection s); //ändert die Anzeige entsprechend des Parameters
+
+    static void isr(); //Flanke an PENIRQ, merkt sich nur den Zeitpunkt
+    static void update(); //entprellt und legt Ereignisse in die Warteschlange
+    static bool pop(Event& e);
+    static void push(Type type);
+
+    static volatile bool pending; //Flanke seit dem letzten update()
+    static volatile unsigned long edge; //Zeitpunkt der letzten Flanke
+    static bool pressed; //entprellter Zustand
+    static bool held; //langer Druck schon gemeldet
+    static unsigned long since; //Beginn des aktuellen Drucks
+    static uint16_t x, y; //Ort des aktuellen Drucks
+
+    static constexpr uint8_t queuesize = 8;
+    static Event queue[queuesize]; //Ringpuffer
+    static uint8_t head, count;
 };
 
 class ds { //Display
 public:
+    static constexpr unsigned long budget = 4; //Zeit in ms, die work() höchstens am Stück zeichnet
+    static constexpr unsigned long idle_after = 60000; //ms ohne Berührung bis zum Ruhezustand
+    static constexpr unsigned long heartbeat = 60000; //ms zwischen zwei Bildern im Ruhezustand
+    static constexpr uint8_t bright = 255, dim = 16; //Hintergrundlicht wach und im Ruhezustand
+
+    using Step = void (*)(); //Ein Stück einer Anzeige, das am Stück gezeichnet wird
+    using Chrome = void (*)(TFT_eSPI& g); //Unveränderliche Teile (Beschriftung, Achsen), weiß auf schwarz
+    struct Page {
+        const Step* steps;
+        uint8_t length;
+        Chrome chrome;
+    };
+
     static void next(); //verändern den Index
     static void prev(); // " "
-    static void refresh(); //aktualisiert die Anzeige mit neusten Daten
+    static void refresh(); //beginnt, die Anzeige mit neusten Daten zu zeichnen
+    static void work(); //zeichnet die angefangene Anzeige weiter, aus loop() aufrufen
+    static bool wake(); //bei jeder Berührung, false wenn die Anzeige erst aufgeweckt wurde
 private:
-    static std::array<std::function<void()>, 2> displays; //die Liste der verfügbaren Anzeigen
+    static void report(unsigned long now); //einmal pro Stunde gesparte Rechenzeit, Kosten je Bild und Zähler von cl über REPORT_PORT ausgeben
+
+    static void prerender(); //zeichnet in der freien Zeit die Nachbaranzeigen vor
+    static void show(int page); //bringt den Hintergrund einer Anzeige auf den Bildschirm
+
+    static std::array<Page, 2> displays; //die Liste der verfügbaren Anzeigen
     static int curr; //Index der aktuellen Anzeige
+    static uint8_t step; //nächster Schritt der aktuellen Anzeige
+    static bool clear; //Bildschirm vor dem ersten Schritt löschen
+
+    //Vorgezeichneter Hintergrund der nächsten [0] und der vorherigen [1] Anzeige, 1 Bit pro Pixel
+    static std::array<TFT_eSprite, 2> images;
+    static std::array<int, 2> imaged; //Index der Anzeige im Bild, -1 für keines
+    static bool nomem; //Speicher für die Bilder hat nicht gereicht
+
+    static bool asleep; //abgedunkelt, nur noch alle 'heartbeat' ms ein Bild
+    static unsigned long touched; //Zeitpunkt der letzten Berührung
+    static unsigned long beat; //Zeitpunkt des letzten Bilds im Ruhezustand
+
+    //Statistik für report(), seit Beginn der Stunde
+    static unsigned long hour; //Beginn der Stunde
+    static unsigned long spent; //µs in work()
+    static uint32_t frames, skipped; //gezeichnete und ausgelassene Bilder
 };
 
 #endif //_DISPLAY_H
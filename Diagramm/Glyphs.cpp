@@ -0,0 +1,107 @@
+#include "Glyphs.h"
+#include "Graphics.h"
+#include <string.h>
+
+namespace gl {
+    struct Glyph {
+        uint8_t width;
+        uint8_t bits[height * max_width/8]; //1 Bit pro Pixel, Zeilen auf ganze Bytes aufgefüllt
+    };
+
+    Glyph glyphs[count];
+
+    //Übernimmt die ersten 'width' Spalten des Sprites als Glyphe
+    void capture(TFT_eSprite& spr, Symbol s, uint8_t width) {
+        Glyph& g = glyphs[s];
+        const uint8_t* src = static_cast<const uint8_t*>(spr.getPointer());
+        uint8_t bytes = (width + 7) / 8;
+
+        g.width = width;
+        for (int row = 0; row < height; ++row)
+            memcpy(g.bits + row*bytes, src + row*(max_width/8), bytes);
+        spr.fillSprite(TFT_BLACK);
+    }
+
+    void init() {
+        TFT_eSprite spr(&tft);
+        spr.setColorDepth(1);
+        spr.createSprite(max_width, height);
+        spr.fillSprite(TFT_BLACK);
+        spr.setTextColor(TFT_WHITE, TFT_BLACK);
+        spr.setTextSize(size);
+
+        int w = spr.textWidth(" ");
+        int h = spr.fontHeight();
+
+        for (int i = 0; i < 10; ++i) {
+            spr.setCursor(0, 0);
+            spr.print(char('0' + i));
+            capture(spr, Symbol(i), w);
+        }
+
+        spr.setCursor(0, 0);
+        spr.print('-');
+        capture(spr, Minus, w);
+
+        //Gradzeichen als kleines 'o' oben, dann das 'C'
+        spr.setTextSize(size-1);
+        spr.setCursor(0, 0);
+        spr.print(" o");
+        spr.setTextSize(size);
+        spr.print('C');
+        capture(spr, Celsius, spr.getCursorX());
+
+        spr.setCursor(0, 0);
+        spr.print("hPa");
+        capture(spr, HPascal, spr.getCursorX());
+
+        spr.setCursor(0, 0);
+        spr.print('%');
+        capture(spr, Percent, w);
+
+        //Durchschnittszeichen: durchgestrichener Kreis
+        spr.drawCircle(w/2, h/2, w/2, TFT_WHITE);
+        spr.drawLine(0, h, w, 0, TFT_WHITE);
+        capture(spr, Average, 2*w);
+
+        //Tendenzpfeile, eineinhalb Zeichen breit
+        gx::drawArrowMore(spr, 0, h - w - size, w - size);
+        capture(spr, Up, w + w/2);
+
+        gx::drawArrowLess(spr, 0, h - w - size, w - size);
+        capture(spr, Down, w + w/2);
+
+        spr.deleteSprite();
+    }
+
+    void put(Symbol s, uint16_t color) {
+        Glyph& g = glyphs[s];
+        int x = tft.getCursorX();
+        int y = tft.getCursorY();
+
+        tft.setBitmapColor(color, tft.textbgcolor);
+        tft.pushImage(x, y, g.width, height, g.bits, false);
+        tft.setCursor(x + g.width, y);
+    }
+
+    void put(Symbol s) {
+        put(s, tft.textcolor);
+    }
+
+    void number(int value) {
+        if (value < 0) {
+            put(Minus);
+            value = -value;
+        }
+
+        char digits[10];
+        int n = 0;
+        do { //Ziffern von hinten nach vorne sammeln
+            digits[n++] = value % 10;
+            value /= 10;
+        } while (value > 0);
+
+        while (n > 0)
+            put(Symbol(digits[--n]));
+    }
+}
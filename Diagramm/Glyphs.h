@@ -0,0 +1,28 @@
+#ifndef _GLYPHS_H
+#define _GLYPHS_H
+
+#include <stdint.h>
+
+namespace gl { //Glyphen, einmal vorgerastert und danach nur noch kopiert
+    constexpr uint8_t size = 2;       //Textgröße, für die gerastert wird
+    constexpr uint8_t height = 8*size;
+    constexpr uint8_t max_width = 40; //Vielfaches von 8, breitestes Symbol ist "hPa"
+
+    enum Symbol { //0 bis 9 sind die Ziffern
+        Minus = 10,
+        Celsius,
+        HPascal,
+        Percent,
+        Average,
+        Up,
+        Down,
+        count
+    };
+
+    void init(); //rastert alle Glyphen, nach tft.init() aufrufen
+    void put(Symbol s, uint16_t color); //kopiert an die Cursorposition und rückt den Cursor weiter
+    void put(Symbol s);                 //in der Textfarbe
+    void number(int value);             //Ziffer für Ziffer in der Textfarbe
+}
+
+#endif //_GLYPHS_H
@@ -0,0 +1,66 @@
+#ifndef _GRADIENTTABLE_H
+#define _GRADIENTTABLE_H
+
+#include "Scale.h"
+#include <pgmspace.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct RGB {
+    uint8_t r, g, b;
+};
+
+//Farbverlauf, der schon beim Kompilieren in eine 565-Farbtabelle umgerechnet wird
+//Deklaration: constexpr GradientTable XY PROGMEM {{BLUE, GREEN, RED}};
+class GradientTable {
+public:
+    static constexpr size_t size = 256; //Anzahl der Einträge
+
+    template<size_t N>
+    constexpr GradientTable(const RGB (&stops)[N]) : table{} {
+        static_assert(N >= 2, "Ein Farbverlauf braucht mindestens zwei Farben");
+        for (size_t i = 0; i < size; ++i) {
+            size_t pos = i * (N - 1);       //Position in Schritten von 1/(size-1) Abschnitt
+            size_t seg = pos / (size - 1);  //Abschnitt zwischen zwei Stützfarben
+            size_t frac = pos % (size - 1); //Anteil innerhalb des Abschnitts
+            if (seg == N - 1) { //Letzter Eintrag liegt genau auf der letzten Farbe
+                seg = N - 2;
+                frac = size - 1;
+            }
+            table[i] = pack(mix(stops[seg].r, stops[seg+1].r, frac),
+                            mix(stops[seg].g, stops[seg+1].g, frac),
+                            mix(stops[seg].b, stops[seg+1].b, frac));
+        }
+    }
+
+    uint16_t operator[](size_t i) const {
+        return pgm_read_word(&table[i]);
+    }
+
+    //Bildet einen Wertebereich auf die Einträge der Tabelle ab
+    static constexpr Scale scale(int lower, int upper) {
+        return {lower, upper, 0, size - 1};
+    }
+
+    uint16_t map(const Scale& index, int value) const { //Wert über 'index' auf seine Farbe abbilden
+        int i = index(value);
+        if (i < 0)
+            i = 0;
+        else if (i > int(size - 1))
+            i = size - 1;
+        return (*this)[i];
+    }
+
+private:
+    static constexpr uint8_t mix(uint8_t a, uint8_t b, size_t frac) {
+        return (a * int(size - 1 - frac) + b * int(frac) + int(size - 1) / 2) / int(size - 1);
+    }
+
+    static constexpr uint16_t pack(uint8_t r, uint8_t g, uint8_t b) {
+        return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+    }
+
+    uint16_t table[size];
+};
+
+#endif //_GRADIENTTABLE_H
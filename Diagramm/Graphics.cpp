@@ -1,4 +1,5 @@
 #include "Graphics.h"
+#include "Glyphs.h"
 
 TFT_eSPI tft;
 void init_tft() {
@@ -7,15 +8,23 @@ void init_tft() {
     tft.setRotation(1);
     tft.setTextColor(TFT_WHITE, TFT_BLACK);
     tft.fillScreen(TFT_BLACK);
+#ifdef TFT_BL
+    analogWriteRange(255); //Auf allen Versionen des ESP8266-Cores dieselben Stufen
+#endif
+    gx::backlight(255);
+    gl::init();
 }
 
 namespace gx {
-    void drawArrowUp(uint16_t x, uint16_t y, uint16_t l, uint16_t color) {
-        tft.fillTriangle(x,y+l, x+l,y+l, x+l/2,y, color);
+    uint8_t Batch::depth = 0;
+    uint32_t Batch::opened = 0;
+
+    void drawArrowUp(uint16_t x, uint16_t y, uint16_t l, uint16_t color, TFT_eSPI& g = tft) {
+        g.fillTriangle(x,y+l, x+l,y+l, x+l/2,y, color);
     }
 
-    void drawArrowDown(uint16_t x, uint16_t y, uint16_t l, uint16_t color) {
-        tft.fillTriangle(x,y, x+l,y, x+l/2,y+l, color);
+    void drawArrowDown(uint16_t x, uint16_t y, uint16_t l, uint16_t color, TFT_eSPI& g = tft) {
+        g.fillTriangle(x,y, x+l,y, x+l/2,y+l, color);
     }
 
     void drawButtonUp(uint16_t x, uint16_t y, uint16_t l, uint16_t color) {
@@ -33,80 +42,56 @@ namespace gx {
         drawButtonDown(0,199,40,TFT_DARKGREY);
     }
 
-    void drawArrowMore(uint16_t x, uint16_t y, uint16_t l) {
-        drawArrowUp(x, y, l, TFT_GREEN);
+    void backlight(uint8_t level) {
+#ifdef TFT_BL //Ohne eigenen Pin bleibt das Licht einfach an
+#if defined(TFT_BACKLIGHT_ON) && TFT_BACKLIGHT_ON == LOW
+        level = 255 - level; //Licht geht bei LOW an
+#endif
+        analogWrite(TFT_BL, level);
+#else
+        (void)level;
+#endif
+    }
+
+    void drawArrowMore(TFT_eSPI& g, uint16_t x, uint16_t y, uint16_t l) {
+        drawArrowUp(x, y, l, TFT_GREEN, g);
         x += 2, y+=4, l -= 4;
-        drawArrowUp(x, y, l, TFT_BLACK);
+        drawArrowUp(x, y, l, TFT_BLACK, g);
     }
 
-    void drawArrowLess(uint16_t x, uint16_t y, uint16_t l) {
-        drawArrowDown(x, y, l, TFT_RED);
+    void drawArrowLess(TFT_eSPI& g, uint16_t x, uint16_t y, uint16_t l) {
+        drawArrowDown(x, y, l, TFT_RED, g);
         x += 1, y-=2, l -= 2;
-        drawArrowDown(x, y, l, TFT_BLACK);
+        drawArrowDown(x, y, l, TFT_BLACK, g);
     }
 }
 
 namespace tx {
     void celsius(int degrees) {
-        tft.print(degrees);
-
-        int x = tft.getCursorX();   //Überschreibe Hintergrund für Gradzeichen
-        tft.print(' ');
-        tft.setCursor(x, tft.getCursorY());
-
-        char size = tft.textsize;
-        tft.setTextSize(size-1);
-        tft.print(" o");
-        tft.setTextSize(size);
-        tft.print('C');
+        gl::number(degrees);
+        gl::put(gl::Celsius);
     }
 
     void hpascal(int hpascal) {
-        tft.print(hpascal);
-        tft.print("hPa");
+        gl::number(hpascal);
+        gl::put(gl::HPascal);
     }
 
     void percent(int percent) {
-        tft.print(percent);
-        tft.print('%');
+        gl::number(percent);
+        gl::put(gl::Percent);
     }
 
     void average() {
-        //sammle Daten
-        int x = tft.getCursorX();
-        int y = tft.getCursorY();
-        int fontWidth = tft.textWidth(" ");
-        //Platz zum Zeichnen
-        tft.print("  ");
-        //Zeichnen
-        tft.drawCircle(x + fontWidth/2, y + tft.fontHeight()/2, fontWidth/2, tft.textcolor);
-        tft.drawLine(x, y + tft.fontHeight(), x + fontWidth, y, tft.textcolor);
+        gl::put(gl::Average);
     }
 
     void tendencyUp() {
-        int x = tft.getCursorX();
-        int y = tft.getCursorY();
-
-        tft.print(' ');
-        char size = tft.textsize;
-        tft.setTextSize(size-1);
-        tft.print(' ');
-
-        tft.setTextSize(size);
-        gx::drawArrowMore(x, y + tft.fontHeight() - tft.textWidth(" ") - size, tft.textWidth(" ") - size);
+        gl::put(gl::Up, TFT_GREEN);
     }
 
     void tendencyDown() {
-        int x = tft.getCursorX();
-        int y = tft.getCursorY();
-
-        tft.print(' ');
-        char size = tft.textsize;
-        tft.setTextSize(size-1);
-        tft.print(' ');
-
-        tft.setTextSize(size);
-        gx::drawArrowLess(x, y + tft.fontHeight() - tft.textWidth(" ") - size, tft.textWidth(" ") - size);
+        gl::put(gl::Down, TFT_RED);
     }
 
     void tab(int down) {
@@ -11,7 +11,28 @@ namespace gx { //Graphics
     constexpr uint16_t left_bound = 50;
     constexpr uint16_t right_bound = 280;
 
+    //Hält Chip-Select und SPI-Transaktion offen, solange das Objekt lebt
+    //Alle Zeichenbefehle dazwischen laufen ohne eigene Transaktion, verschachtelt zählt nur das äußerste
+    //Gespart wird nur das Öffnen und Schließen der Transaktion; Pixel und Striche fasst TFT_eSPI schon
+    //selbst zusammen (drawLine schiebt waagrechte und senkrechte Stücke je als ein Fenster)
+    class Batch {
+    public:
+        Batch() { if (depth++ == 0) { tft.startWrite(); ++opened; } }
+        ~Batch() { if (--depth == 0) tft.endWrite(); }
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+        static uint32_t transactions() { return opened; } //seit dem letzten reset() geöffnet
+        static void reset() { opened = 0; }
+    private:
+        static uint8_t depth; //Anzahl offener Batches
+        static uint32_t opened; //geöffnete Transaktionen, für ds::report()
+    };
+
     void drawButtons();
+    void backlight(uint8_t level); //Helligkeit des Hintergrundlichts per PWM, 0 bis 255
+    void drawArrowMore(TFT_eSPI& g, uint16_t x, uint16_t y, uint16_t l); //Tendenzpfeile, auch in Sprites
+    void drawArrowLess(TFT_eSPI& g, uint16_t x, uint16_t y, uint16_t l);
 }
 
 namespace tx { //Text und Symbole
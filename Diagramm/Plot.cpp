@@ -1,5 +1,6 @@
 #include "Plot.h"
 #include "Graphics.h"
+#include <math.h>
 
 using namespace std;
 using namespace gx;
@@ -7,50 +8,126 @@ using namespace gx;
 namespace bar {
     void draw(int y, int dx, uint16_t color) {
         tft.fillRect(left_bound, y, dx, 20, color); //Der eigentliche Balken
-        tft.fillRect(left_bound+dx, y, right_bound-left_bound-dx, 20, TFT_BLACK); //Schwarze Überdeckung falls der Balken vorher größer war
+        tft.fillRect(left_bound+dx, y, right_bound-left_bound-dx, 19, TFT_BLACK); //Schwarze Überdeckung falls der Balken vorher größer war
         tft.drawFastHLine(left_bound+dx, y+19, right_bound-left_bound-dx, TFT_WHITE);  //Der weiße Strich zur Orientierung
     }
-
-    int mapx(Range origin, int value) {
-        return map({1, right_bound - left_bound}, origin, value);
-    }
 }
 
 namespace gph {
-    constexpr uint16_t upper_bound = 10 + 16*3;
-    constexpr uint16_t lower_bound = 235;
+    constexpr Scale ticks{0, 7, lower_bound, upper_bound}; //Höhe der sieben Striche an der y-Achse
+
+    void AutoScale::update(float min, float max) {
+        float span = max - min;
+        if (span * 3 < min_span * 2) //Kleine Schwankungen dürfen den Bereich bis 2 * 'min_span' nutzen
+            span = min_span * 2 / 3.0f;
+
+        //Daten liegen im Bereich und nutzen mindestens ein Drittel davon: nichts tun
+        if (min >= lower && max <= upper && (upper - lower) <= span * 3)
+            return;
+
+        //Neuer Bereich mit je einem Viertel Luft oben und unten
+        float from = min - (max - min) / 4;
+        float to = max + (max - min) / 4;
+        if (to - from < min_span) { //Zu schmal: um die Mitte auf 'min_span' verbreitern
+            float mid = (min + max) / 2;
+            from = mid - min_span / 2.0f;
+            to = mid + min_span / 2.0f;
+        }
 
-    void drawAxis() {
-        int zero = map({lower_bound,upper_bound}, {0,7}, 1); //Höhe der x-Achse
+        //Auf ganze Einheiten nach außen gerundet, bleibt also mindestens 'min_span' groß
+        int lo = floorf(from);
+        int hi = ceilf(to);
+        if (lo == lower && hi == upper)
+            return;
 
-        tft.fillRect(left_bound + 3, upper_bound, right_bound-left_bound - 3, zero-upper_bound, TFT_BLACK); //Hintergrund übermalen
-        tft.fillRect(left_bound + 3, zero + 1, right_bound-left_bound - 3, lower_bound-zero, TFT_BLACK);
+        lower = lo;
+        upper = hi;
+        s = scale(lo, hi);
+    }
+
+    void drawAxis(TFT_eSPI& g) {
+        int zero = lower_bound + 2; //Höhe der x-Achse, unterhalb der Zeichenfläche
 
-        tft.drawFastVLine(left_bound + 2, upper_bound, lower_bound-upper_bound+2, TFT_WHITE); //y-Achse
-        tft.fillTriangle(left_bound + 2, upper_bound, left_bound, upper_bound + 5, left_bound + 4, upper_bound + 5, TFT_WHITE); //Pfeilpitze
+        g.drawFastVLine(left_bound + 2, upper_bound, lower_bound-upper_bound+3, TFT_WHITE); //y-Achse
+        g.fillTriangle(left_bound + 2, upper_bound, left_bound, upper_bound + 5, left_bound + 4, upper_bound + 5, TFT_WHITE); //Pfeilpitze
 
-        tft.drawFastHLine(left_bound, zero, right_bound-left_bound, TFT_WHITE); //x-Achse
-        tft.fillTriangle(right_bound, zero, right_bound - 5, zero - 2, right_bound - 5, zero + 2, TFT_WHITE); //Pfeilspitze
+        g.drawFastHLine(left_bound, zero, right_bound-left_bound, TFT_WHITE); //x-Achse
+        g.fillTriangle(right_bound, zero, right_bound - 5, zero - 2, right_bound - 5, zero + 2, TFT_WHITE); //Pfeilspitze
 
-        //Zeichnet sieben Striche von -20n bis 120n ein, wobei n 1°C bzw. 10hPa bzw. 1% entspricht
+        //Sieben Striche links der y-Achse, die Zeichenfläche in sechs gleiche Teile geteilt
         for (int i = 0; i < 7; ++i) {
-            tft.drawFastHLine(left_bound,
-                              map({lower_bound,upper_bound}, {0,7}, i),
-                              5, TFT_WHITE);
+            g.drawFastHLine(left_bound - 2, ticks(i), 4, TFT_WHITE);
         }
     }
 
-    void drawGraph(Range origin, std::vector<int> values, uint32_t color) {
+    void clear() {
+        //Neben der Pfeilspitze der y-Achse etwas schmaler, damit sie stehen bleibt
+        tft.fillRect(plot_left + 2, upper_bound, plot_right - plot_left - 1, 6, TFT_BLACK);
+        tft.fillRect(plot_left, upper_bound + 6, plot_right - plot_left + 1, lower_bound - upper_bound - 5, TFT_BLACK);
+    }
+
+    constexpr uint16_t width = plot_right - plot_left + 1; //Breite der Zeichenfläche in Pixeln
+
+    //Wert 'field' der i-ten Aufzeichnung, gerundet statt abgeschnitten
+    int value(int i, float Record::*field) {
+        return lroundf(rc::at(i).*field);
+    }
+
+    struct Column { //Zusammenfassung aller Werte, die auf dieselbe Pixelspalte fallen
+        int first, last, min, max;
+    };
+
+    //Zeichnet eine Spalte als senkrechten Strich von min bis max und verbindet sie mit der vorherigen
+    void drawColumn(const Scale& y, int x, const Column* prev, const Column& col, uint32_t color) {
+        int y_min = y(col.min);
+        int y_max = y(col.max);
+
+        if (prev) //Die erste Spalte hat keinen Vorgänger
+            tft.drawLine(x - 1, y(prev->last), x, y(col.first), color);
+        tft.drawFastVLine(x, y_max, y_min - y_max + 1, color);
+    }
+
+    //Mehr Werte als Pixelspalten: je Spalte nur Minimum und Maximum zeichnen, damit Spitzen sichtbar bleiben
+    void drawDecimated(const Scale& x, const Scale& y, float Record::*field, uint32_t color) {
+        int v = value(0, field);
+        Column prev;
+        Column col{v, v, v, v};
+        int curr = x(0); //aktuelle Spalte
+
+        for (int i = 1; i < rc::length(); ++i) {
+            v = value(i, field);
+            int c = x(i);
+            if (c != curr) { //Spalte ist fertig
+                drawColumn(y, curr, curr != x(0) ? &prev : nullptr, col, color);
+                prev = col;
+                col = {v, v, v, v};
+                curr = c;
+                continue;
+            }
+            col.last = v;
+            if (v < col.min)
+                col.min = v;
+            if (v > col.max)
+                col.max = v;
+        }
+        drawColumn(y, curr, &prev, col, color);
+    }
+
+    void drawGraph(const Scale& x, const Scale& y, float Record::*field, uint32_t color) {
+        if (rc::length() > width) {
+            drawDecimated(x, y, field, color);
+            return;
+        }
+
         //Zeichnet immer Striche von Wert zu Wert
-        //Die Menge der Werte bestimmt die Verzerrung in x-Richtung
-        for (int i = 1; i < values.size(); ++i) {
-            tft.drawLine(map({left_bound+2, right_bound}, {0, values.size()}, i-1), //x-Position, gemappt von der Länge der Werteliste
-                         map({lower_bound, upper_bound}, origin, values[i-1]), //Höhe des ersten Punktes je nach 'origin'
-
-                         map({left_bound+2, right_bound}, {0, values.size()}, i), //Zweiter Punkt
-                         map({lower_bound, upper_bound}, origin, values[i]),
-                         
+        //'x' bestimmt über die Menge der Werte die Verzerrung in x-Richtung, 'y' die Höhe je nach Wertebereich
+        int prev = y(value(0, field));
+        for (int i = 1; i < rc::length(); ++i) {
+            int curr = y(value(i, field));
+            tft.drawLine(x(i-1), prev, //Erster Punkt
+                         x(i), curr,   //Zweiter Punkt
                          color);
+            prev = curr;
         }
     }
 }
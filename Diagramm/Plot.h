@@ -1,18 +1,55 @@
 #ifndef _PLOT_H
 #define _PLOT_H
 
-#include "Range.h"
+#include "Graphics.h"
+#include "Record.h"
+#include "Scale.h"
 #include <stdint.h>
-#include <vector>
 
 namespace bar { //Bar
     void draw(int y, int dx, uint16_t color);
-    int mapx(Range origin, int x); //Hilfe, um richtig auf die richtige Länge 'dx' zu mappen
+
+    //Hilfe, um richtig auf die richtige Länge 'dx' zu mappen
+    constexpr Scale scale(int lower, int upper) {
+        return {lower, upper, 1, gx::right_bound - gx::left_bound};
+    }
 }
 
 namespace gph { //Graph
-    void drawAxis();
-    void drawGraph(Range origin, std::vector<int> values, uint32_t color);
+    constexpr uint16_t upper_bound = 10 + 16*3;
+    constexpr uint16_t lower_bound = 235;
+    constexpr uint16_t plot_left = gx::left_bound + 3;   //Zeichenfläche rechts der y-Achse
+    constexpr uint16_t plot_right = gx::right_bound - 6; //und links der Pfeilspitze der x-Achse
+
+    //Bildet den Wertebereich auf die Höhe der Zeichenfläche ab
+    constexpr Scale scale(int lower, int upper) {
+        return {lower, upper, lower_bound, upper_bound};
+    }
+
+    //Bildet den Index eines Wertes auf die x-Position ab, einmal pro Bild für alle Graphen
+    inline Scale time(int length) {
+        return {0, length, plot_left, plot_right};
+    }
+
+    //Wertebereich eines Graphen, der sich an die Daten anpasst
+    //Hysterese: neu skaliert wird nur, wenn die Daten den Bereich verlassen oder ihn kaum noch nutzen
+    class AutoScale {
+    public:
+        constexpr AutoScale(int lower, int upper, int min_span)
+            : lower(lower), upper(upper), min_span(min_span), s(scale(lower, upper)) {}
+
+        void update(float min, float max); //passt den Bereich an, wenn die Daten ihn verlassen oder zu wenig nutzen
+        const Scale& get() const { return s; }
+    private:
+        int lower, upper; //aktueller Bereich
+        int min_span; //kleinster Bereich, damit Rauschen nicht bildfüllend wird
+        Scale s; //nur bei Änderung neu berechnet
+    };
+
+    void drawAxis(TFT_eSPI& g); //Achsen und Striche, liegen außerhalb der Zeichenfläche, auch in Sprites
+    void clear(); //übermalt nur die Zeichenfläche
+    //Zeichnet 'field' aller Aufzeichnungen direkt aus rc, ohne Zwischenliste
+    void drawGraph(const Scale& x, const Scale& y, float Record::*field, uint32_t color);
 }
 
 #endif //_PLOT_H
@@ -13,7 +13,7 @@ void init_bme() {
     }
 }
 
-std::deque<Record> rc::records = {
+Record rc::records[recordsize] = {
     {20,1000,50},
     {22,1001,60},
     {23,1002,72},
@@ -23,11 +23,17 @@ std::deque<Record> rc::records = {
     //,{50,1100,100}
     //,{-20,900,0}
 };
+uint8_t rc::first = 0;
+uint8_t rc::count = 6;
 
 void rc::add(Record r) {
-    if (records.size() >= recordsize) //Löscht alte Werte, wenn die Liste zu lang wird
-        records.pop_front();
-    records.emplace_back(r);
+    if (count < recordsize) {
+        records[(first + count) % recordsize] = r;
+        ++count;
+    } else { //Überschreibt den ältesten Wert, wenn die Liste voll ist
+        records[first] = r;
+        first = (first + 1) % recordsize;
+    }
 }
 
 void rc::measure() {
@@ -37,32 +43,34 @@ void rc::measure() {
 }
 
 Record rc::at(int i) {
-    if (i < 0 || records.size() - 1 < i) //Bei Zugriff außerhalb der Grenzen
+    if (i < 0 || count <= i) //Bei Zugriff außerhalb der Grenzen
         return {NAN,NAN,NAN};
-    return records[i];
+    return records[(first + i) % recordsize];
 }
 
 int rc::length() {
-    return records.size();
+    return count;
 }
 
 Record rc::average() {
     Record acc{0,0,0};
-    for (auto &r : records) {
+    for (int i = 0; i < count; ++i) {
+        Record r = at(i);
         acc.temp += r.temp;
         acc.press += r.press;
         acc.humid += r.humid;
     }
-    acc.temp /= records.size();
-    acc.press /= records.size();
-    acc.humid /= records.size();
+    acc.temp /= count;
+    acc.press /= count;
+    acc.humid /= count;
 
     return acc;
 }
 
 Record rc::max() {
     Record max = at(0);
-    for (auto &r : records) {
+    for (int i = 1; i < count; ++i) {
+        Record r = at(i);
         if (max.temp < r.temp)
             max.temp = r.temp;
         if (max.press < r.press)
@@ -75,7 +83,8 @@ Record rc::max() {
 
 Record rc::min() {
     Record min = at(0);
-    for (auto &r : records) {
+    for (int i = 1; i < count; ++i) {
+        Record r = at(i);
         if (min.temp > r.temp)
             min.temp = r.temp;
         if (min.press > r.press)
@@ -3,7 +3,7 @@
 
 #include <BME280I2C.h>
 #include <Wire.h>
-#include <deque>
+#include <type_traits>
 
 extern BME280I2C bme;
 void init_bme();
@@ -11,6 +11,9 @@ void init_bme();
 struct Record {
     float temp, press, humid;
 };
+//rc::at() gibt Kopien heraus, die Graphen lesen je Bild jeden Wert; das bleibt nur ohne Heap,
+//solange Record keine Member mit eigenem Speicher (String, vector) bekommt
+static_assert(std::is_trivially_copyable<Record>::value, "Record muss ohne Heap kopierbar bleiben"); //extras/test/host/testHistory zählt die Allokationen je Bild nach
 
 class rc { //Record
 public:
@@ -18,13 +21,15 @@ public:
 
     static void measure(); //Misst mit bme
     static void add(Record r);
-    static Record at(int i);
+    static Record at(int i);  //0 ist der älteste Wert
     static int length();
     static Record average(); //Die Werte sind nicht unbedingt zur gleichen Zeit entstanden
     static Record max();     //*
     static Record min();     //*
 private:
-    static std::deque<Record> records;
+    static Record records[recordsize]; //Ringpuffer, wird nie neu angelegt
+    static uint8_t first;              //Index des ältesten Wertes
+    static uint8_t count;              //Anzahl der gültigen Werte
 };
 
 #endif //_RECORD_H
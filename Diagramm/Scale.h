@@ -0,0 +1,26 @@
+#ifndef _SCALE_H
+#define _SCALE_H
+
+#include <stdint.h>
+
+//Lineare Abbildung von [from_lo, from_hi] nach [to_lo, to_hi] in Festkomma (Q16)
+//Steigung und Versatz werden einmal pro Bereich berechnet, danach kostet jeder Punkt
+//nur eine Subtraktion, eine Multiplikation und eine Verschiebung.
+//Gerechnet wird ab 'from_lo', damit bleibt |k * (v - from_lo)| für Werte im Bereich unter
+//|to_hi - to_lo| * 2^16, auch wenn der Bereich weit von 0 liegt (Luftdruck um 1000hPa)
+struct Scale {
+    int32_t k;  //Steigung in Q16
+    int32_t lo; //Anfang des Wertebereichs
+    int32_t d;  //Versatz in Q16, +0.5 zum Runden schon eingerechnet
+
+    constexpr Scale(int32_t from_lo, int32_t from_hi, int32_t to_lo, int32_t to_hi)
+        : k(int32_t(int64_t(to_hi - to_lo) * 65536 / (from_hi - from_lo))),
+          lo(from_lo),
+          d(int32_t(int64_t(to_lo) * 65536 + 32768)) {}
+
+    constexpr int32_t operator()(int32_t v) const {
+        return (k * (v - lo) + d) >> 16;
+    }
+};
+
+#endif //_SCALE_H
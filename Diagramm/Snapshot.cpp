@@ -0,0 +1,91 @@
+#include "Snapshot.h"
+#include "Graphics.h"
+#include <string.h>
+
+void init_snapshot() {
+    Serial.println("Initialisiere Snapshot");
+    SNAPSHOT_PORT.begin(115200);
+}
+
+uint16_t sn::pixels[sn::width];
+uint8_t sn::out[sn::width * 3];
+uint16_t sn::length = 0, sn::sent = 0;
+int16_t sn::row = 0;
+bool sn::running = false;
+
+void sn::start() {
+    if (running)
+        return;
+    running = true;
+    row = -1;
+    length = sent = 0;
+}
+
+bool sn::busy() {
+    return running;
+}
+
+void sn::put(const char magic[4]) {
+    memcpy(out + length, magic, 4);
+    length += 4;
+}
+
+void sn::put(uint8_t count, uint16_t color) {
+    color = (color >> 8) | (color << 8); //readRect() liefert die Bytes vertauscht, passend zu pushRect()
+    out[length++] = count;
+    out[length++] = color & 0xFF;
+    out[length++] = color >> 8;
+}
+
+void sn::encode() {
+    length = sent = 0;
+
+    if (row < 0) { //Kopf
+        put("SNAP");
+        out[length++] = width & 0xFF;
+        out[length++] = width >> 8;
+        out[length++] = height & 0xFF;
+        out[length++] = height >> 8;
+    } else if (row < height) {
+        tft.readRect(0, row, width, 1, pixels); //Eigene Transaktion, also nicht in einem gx::Batch
+
+        uint16_t color = pixels[0];
+        uint8_t count = 1;
+        for (uint16_t x = 1; x < width; ++x) {
+            if (pixels[x] == color && count < 255) {
+                ++count;
+                continue;
+            }
+            put(count, color);
+            color = pixels[x];
+            count = 1;
+        }
+        put(count, color);
+    } else {
+        put("DONE");
+    }
+    ++row;
+}
+
+void sn::work() {
+    if (!running)
+        return;
+
+    unsigned long start = millis();
+    do {
+        if (sent == length) {
+            if (row > height) { //Ende ist schon gesendet
+                running = false;
+                return;
+            }
+            encode();
+        }
+        //Nur so viel, wie ohne Warten in den Sendepuffer passt
+        size_t n = SNAPSHOT_PORT.availableForWrite();
+        if (n == 0)
+            return;
+        if (n > size_t(length - sent))
+            n = length - sent;
+        sent += SNAPSHOT_PORT.write(out + sent, n);
+    } while (millis() - start < budget);
+}
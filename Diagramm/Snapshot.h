@@ -0,0 +1,38 @@
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#ifndef SNAPSHOT_PORT
+#define SNAPSHOT_PORT Serial1 //TX an GPIO2 (D4), RX/TX von Serial sind schon der I2C-Bus
+#endif
+
+void init_snapshot();
+
+//Liest den Bildschirm zeilenweise aus dem GRAM zurück und schickt ihn lauflängenkodiert über SNAPSHOT_PORT
+//Format: "SNAP", Breite und Höhe (uint16), dann je Zeile Läufe aus Anzahl (uint8) und Farbe (uint16, 565),
+//        zum Schluss "DONE"; alles little-endian. Auswerten mit tools/snapshot.py
+//Zwischen den Aufnahmen schreibt ds::report() Text auf denselben Port, snapshot.py überspringt ihn bis "SNAP"
+//Zum Zurücklesen muss TFT_MISO angeschlossen sein
+class sn { //Snapshot
+public:
+    static constexpr unsigned long budget = 2; //Zeit in ms, die work() höchstens am Stück sendet
+    static constexpr uint16_t width = 320, height = 240;
+
+    static void start(); //beginnt eine Aufnahme, falls gerade keine läuft
+    static bool busy(); //während der Aufnahme darf nicht gezeichnet werden
+    static void work(); //sendet das nächste Stück, aus loop() aufrufen
+private:
+    static void encode(); //liest die nächste Zeile und kodiert sie in 'out'
+    static void put(const char magic[4]);
+    static void put(uint8_t count, uint16_t color);
+
+    static uint16_t pixels[width]; //eine Zeile aus dem GRAM
+    static uint8_t out[width * 3]; //kodierte Zeile, schlimmstenfalls ein Lauf je Pixel
+    static uint16_t length, sent; //Füllstand von 'out' und schon davon gesendet
+    static int16_t row; //nächste Zeile, -1 vor dem Kopf, 'height' vor dem Ende
+    static bool running;
+};
+
+#endif //_SNAPSHOT_H
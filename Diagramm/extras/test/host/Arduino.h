@@ -0,0 +1,18 @@
+//Gerade genug vom ESP8266-Core, um Record.cpp und Plot.cpp auf dem PC zu übersetzen, siehe run.sh
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+inline void delay(unsigned long) {}
+
+struct HardwareSerial {
+    void println(const char* text) { puts(text); }
+};
+extern HardwareSerial Serial;
+
+#endif //Arduino_h
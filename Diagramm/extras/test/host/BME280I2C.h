@@ -0,0 +1,12 @@
+#ifndef BME280I2C_h
+#define BME280I2C_h
+
+#include <Arduino.h>
+
+class BME280I2C { //Misst nie, die Tests füllen rc selbst
+public:
+    bool begin() { return true; }
+    void read(float& p, float& t, float& h) { p = t = h = NAN; }
+};
+
+#endif //BME280I2C_h
@@ -0,0 +1,68 @@
+/*
+  A few ArduinoUnit look-alikes, the same as in ThingSpeakButNotJava/extras/test/host, see run.sh.
+
+  test(name) { ... } registers a case, runTests() runs them in order and returns the number that failed.
+  An assert that fails reports itself and ends its case.
+*/
+
+#ifndef HostTest_h
+#define HostTest_h
+
+#include <stdio.h>
+
+class HostTest {
+  public:
+    HostTest(const char * name, void (*run)()) : name(name), run(run) {
+        HostTest ** last = &first();
+        while(*last != NULL) last = &(*last)->next;
+        *last = this;
+    }
+
+    static bool & failed() {
+        static bool failed;
+        return failed;
+    }
+
+    static int runTests() {
+        int passed = 0, failures = 0;
+        for(HostTest * test = first(); test != NULL; test = test->next){
+            failed() = false;
+            test->run();
+            printf("Test %s %s.\n", test->name, failed() ? "failed" : "passed");
+            if(failed()) failures++;
+            else passed++;
+        }
+        printf("Test summary: %d passed, %d failed, and 0 skipped, out of %d test(s).\n", passed, failures, passed + failures);
+        return failures;
+    }
+
+  private:
+    const char * name;
+    void (*run)();
+    HostTest * next = NULL;
+
+    static HostTest *& first() {
+        static HostTest * first = NULL;
+        return first;
+    }
+};
+
+#define test(name) \
+    static void name##Run(); \
+    static HostTest name##Test(#name, name##Run); \
+    static void name##Run()
+
+#define assertTrue(condition) \
+    do { \
+        if(!(condition)){ \
+            printf("Assertion failed: (%s), file %s, line %d.\n", #condition, __FILE__, __LINE__); \
+            HostTest::failed() = true; \
+            return; \
+        } \
+    } while(0)
+
+#define assertFalse(condition) assertTrue(!(condition))
+#define assertEqual(expected, actual) assertTrue((expected) == (actual))
+#define assertNotEqual(expected, actual) assertTrue(!((expected) == (actual)))
+
+#endif
@@ -0,0 +1 @@
+//Leer, TFT_eSPI.h hier kommt ohne SPI aus
@@ -0,0 +1,50 @@
+//Steht für TFT_eSPI mit den paar Zeichenbefehlen, die Plot.cpp braucht, siehe run.sh
+//Statt zu zeichnen zählt es die Befehle und die SPI-Transaktionen. Wann eine Transaktion aufgeht,
+//folgt der Bibliothek: jeder Befehl öffnet und schließt seine eigene, außer zwischen startWrite() und endWrite()
+#ifndef TFT_eSPI_h
+#define TFT_eSPI_h
+
+#include <Arduino.h>
+
+#define TFT_BLACK 0x0000
+#define TFT_WHITE 0xFFFF
+#define TFT_DARKGREY 0x7BEF
+#define TFT_GREEN 0x07E0
+
+class TFT_eSPI {
+public:
+    uint32_t transactions = 0; //SPI.beginTransaction() mit Chip-Select
+    uint32_t primitives = 0; //Zeichenbefehle
+
+    void startWrite() { begin(); locked = true; }
+    void endWrite() { locked = false; end(); }
+
+    void fillRect(int32_t, int32_t, int32_t, int32_t, uint32_t) { draw(); }
+    void drawLine(int32_t, int32_t, int32_t, int32_t, uint32_t) { draw(); } //Eine Transaktion für die ganze Linie
+    void drawFastHLine(int32_t, int32_t, int32_t, uint32_t) { draw(); }
+    void drawFastVLine(int32_t, int32_t, int32_t, uint32_t) { draw(); }
+    void fillTriangle(int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, uint32_t) { draw(); }
+
+    void reset() { transactions = primitives = 0; }
+private:
+    bool open = false; //Transaktion läuft
+    bool locked = false; //startWrite() hält sie offen
+
+    void begin() {
+        if (!open) {
+            open = true;
+            ++transactions;
+        }
+    }
+    void end() {
+        if (!locked)
+            open = false;
+    }
+    void draw() {
+        begin();
+        ++primitives;
+        end();
+    }
+};
+
+#endif //TFT_eSPI_h
@@ -0,0 +1,9 @@
+#ifndef Wire_h
+#define Wire_h
+
+struct TwoWire {
+    void begin(int, int) {}
+};
+extern TwoWire Wire;
+
+#endif //Wire_h
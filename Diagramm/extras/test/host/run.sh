@@ -0,0 +1,34 @@
+#!/bin/sh
+# Übersetzt die Tests für den PC mit dessen C++-Compiler und führt sie aus.
+#
+#   extras/test/host/run.sh                    alle Tests
+#   extras/test/host/run.sh testHistory [...]  ein Test, die weiteren Argumente gehen an ihn
+#
+# Arduino.h, BME280I2C.h, Wire.h und SPI.h stehen für den ESP8266-Core und die Bibliotheken,
+# TFT_eSPI.h zählt Zeichenbefehle und SPI-Transaktionen, statt zu zeichnen.
+# CXX und CXXFLAGS kommen aus der Umgebung.
+
+cd "$(dirname "$0")" || exit 1
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2 -Wall}
+BUILD=${TMPDIR:-/tmp}/diagramm-host-test
+mkdir -p "$BUILD" || exit 1
+
+run() {
+    name=$1
+    shift
+    $CXX -std=gnu++11 $CXXFLAGS -I. -I../../.. -o "$BUILD/$name" "$name.cpp" ../../../Plot.cpp ../../../Record.cpp || return 1
+    "$BUILD/$name" "$@"
+}
+
+if [ $# -gt 0 ]; then
+    run "$@"
+    exit $?
+fi
+
+failed=0
+for test in test*.cpp; do
+    echo "== ${test%.cpp}"
+    run "${test%.cpp}" || failed=1
+done
+exit $failed
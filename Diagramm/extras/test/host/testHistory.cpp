@@ -0,0 +1,100 @@
+//Ein Bild der Verlaufsanzeige auf dem PC: Plot.cpp zeichnet direkt aus rc (Record.cpp) auf den zählenden TFT_eSPI.h von hier
+//Die Schritte sind die aus 'history' in Display.cpp ohne die Legende, deren Text dort gesetzt wird
+#include "HostTest.h"
+#include "Plot.h"
+#include <new>
+
+HardwareSerial Serial;
+TwoWire Wire;
+
+//Statt Graphics.cpp, das die Glyphen und Sprites mitbrächte
+TFT_eSPI tft;
+uint8_t gx::Batch::depth = 0;
+uint32_t gx::Batch::opened = 0;
+
+static long allocations = 0;
+
+void* operator new(size_t size) {
+    ++allocations;
+    void* memory = malloc(size ? size : 1);
+    if (memory == nullptr)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+//Wie in Display.cpp
+static gph::AutoScale TS{-20, 120, 2};
+static gph::AutoScale PS{900, 1100, 2};
+static gph::AutoScale HS{-20, 120, 5};
+
+//Volle Aufzeichnung mit Werten, die über den Ausgangsbereich der Skalen hinausgehen
+static void fill() {
+    for (int i = 0; i < rc::recordsize; ++i)
+        rc::add({18.0f + i * 0.7f, 990.0f + (i % 7) * 3.5f, 40.0f + (i % 5) * 9.0f});
+}
+
+static void frame() {
+    Record max = rc::max();
+    Record min = rc::min();
+    Scale x = gph::time(rc::length());
+    TS.update(min.temp, max.temp);
+    PS.update(min.press, max.press);
+    HS.update(min.humid, max.humid);
+
+    gph::clear();
+    gph::drawGraph(x, TS.get(), &Record::temp, TFT_WHITE);
+    gph::drawGraph(x, PS.get(), &Record::press, TFT_WHITE);
+    gph::drawGraph(x, HS.get(), &Record::humid, TFT_WHITE);
+}
+
+test(historyAllocationsCase) {
+    fill();
+    frame(); //Die Skalen stellen sich im ersten Bild ein
+
+    long before = allocations;
+    for (int i = 0; i < 10; ++i) {
+        rc::add({25.0f + i, 1005.0f - i, 55.0f + i});
+        frame();
+    }
+    long counted = allocations - before;
+    printf("%ld Allokationen in 10 Bildern mit %d Werten\n", counted, rc::length());
+    assertEqual(0L, counted);
+}
+
+test(historyBatchCase) {
+    fill();
+    frame();
+
+    tft.reset();
+    frame();
+    uint32_t unbatched = tft.transactions;
+    uint32_t primitives = tft.primitives;
+
+    //ds::work() zeichnet das Bild mit einem Batch je Aufruf, meist alle Schritte in einem
+    tft.reset();
+    gx::Batch::reset();
+    {
+        gx::Batch batch;
+        frame();
+    }
+    uint32_t batched = tft.transactions;
+
+    printf("Ein Bild: %u Zeichenbefehle, %u Transaktionen ohne gx::Batch, %u mit\n",
+           (unsigned)primitives, (unsigned)unbatched, (unsigned)batched);
+    assertEqual(primitives, unbatched);
+    assertEqual(primitives, tft.primitives);
+    assertEqual(1u, batched);
+    assertEqual(1u, gx::Batch::transactions());
+}
+
+int main() {
+    return HostTest::runTests();
+}
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Wandelt eine Bildschirmaufnahme der Wetterstation in ein PNG um.
+
+Die Station schickt nach einem langen Druck auf den Bildschirm ihr Bild
+über SNAPSHOT_PORT (siehe Snapshot.h). Aufnehmen direkt vom Adapter:
+
+    python3 snapshot.py /dev/ttyUSB0 bild.png
+
+oder aus einer mitgeschnittenen Datei:
+
+    python3 snapshot.py mitschnitt.bin bild.png
+
+Für den seriellen Port wird pyserial gebraucht, sonst nur die Standardbibliothek.
+"""
+
+import struct
+import sys
+import zlib
+
+
+def open_source(name, baud):
+    if name.startswith("/dev/") or name.upper().startswith("COM"):
+        import serial  # pyserial
+
+        return serial.Serial(name, baud, timeout=10)
+    return open(name, "rb")
+
+
+def read_exact(src, n):
+    data = b""
+    while len(data) < n:
+        chunk = src.read(n - len(data))
+        if not chunk:
+            raise EOFError("Aufnahme bricht nach %d Bytes ab" % len(data))
+        data += chunk
+    return data
+
+
+def sync(src):
+    """Überspringt alles bis zum Kopf "SNAP", etwa Ausgaben vom Start."""
+    window = b""
+    while window != b"SNAP":
+        window = (window + read_exact(src, 1))[-4:]
+
+
+def decode(src):
+    sync(src)
+    width, height = struct.unpack("<HH", read_exact(src, 4))
+    rows = []
+    for _ in range(height):
+        row = bytearray()
+        filled = 0
+        while filled < width:
+            count, color = struct.unpack("<BH", read_exact(src, 3))
+            if count == 0 or filled + count > width:
+                raise ValueError("Lauf passt nicht in die Zeile %d" % len(rows))
+            r = (color >> 11) & 0x1F
+            g = (color >> 5) & 0x3F
+            b = color & 0x1F
+            # 565 auf volle 8 Bit strecken
+            pixel = bytes(((r * 255 + 15) // 31, (g * 255 + 31) // 63, (b * 255 + 15) // 31))
+            row += pixel * count
+            filled += count
+        rows.append(bytes(row))
+    if read_exact(src, 4) != b"DONE":
+        raise ValueError("Ende der Aufnahme fehlt")
+    return width, height, rows
+
+
+def png_chunk(kind, data):
+    body = kind + data
+    return struct.pack(">I", len(data)) + body + struct.pack(">I", zlib.crc32(body) & 0xFFFFFFFF)
+
+
+def write_png(name, width, height, rows):
+    raw = b"".join(b"\x00" + row for row in rows)  # Filter 0 je Zeile
+    with open(name, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(png_chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0)))
+        f.write(png_chunk(b"IDAT", zlib.compress(raw, 9)))
+        f.write(png_chunk(b"IEND", b""))
+
+
+def main():
+    if len(sys.argv) not in (3, 4):
+        print("Aufruf: snapshot.py <port|datei> <bild.png> [baud]", file=sys.stderr)
+        return 2
+    baud = int(sys.argv[3]) if len(sys.argv) == 4 else 115200
+    with open_source(sys.argv[1], baud) as src:
+        width, height, rows = decode(src)
+    write_png(sys.argv[2], width, height, rows)
+    print("%dx%d nach %s geschrieben" % (width, height, sys.argv[2]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
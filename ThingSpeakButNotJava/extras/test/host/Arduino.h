@@ -0,0 +1,178 @@
+/*
+  Just enough of the Arduino core to build the ThingSpeak library on a PC, see run.sh.
+
+  millis() runs on the PC clock plus hostMillisOffset(), so a test can step over the
+  rate limit or a timeout without waiting for it.
+
+  See the accompaning licence file for licensing information.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+using std::isinf;
+using std::isnan;
+using std::min;
+
+inline unsigned long & hostMillisOffset() {
+    static unsigned long offset = 0;
+    return offset;
+}
+
+inline unsigned long millis() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() + hostMillisOffset();
+}
+
+inline void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void yield() {}
+
+inline char * itoa(int value, char * text, int) {
+    sprintf(text, "%d", value);
+    return text;
+}
+
+inline char * ltoa(long value, char * text, int) {
+    sprintf(text, "%ld", value);
+    return text;
+}
+
+inline char * ultoa(unsigned long value, char * text, int) {
+    sprintf(text, "%lu", value);
+    return text;
+}
+
+inline char * dtostrf(double value, signed char width, unsigned char decimals, char * text) {
+    sprintf(text, "%*.*f", width, decimals, value);
+    return text;
+}
+
+// Keeps its text on the heap like the AVR one, even a short one, and allocates through operator
+// new, so a test that counts those sees every String that is made or grows
+class String {
+  public:
+    String(const char * text = "") { append(text ? text : "", text ? strlen(text) : 0); }
+    String(const String & other) { append(other.c_str(), other.size); }
+    explicit String(int value) { append(std::to_string(value)); }
+    explicit String(unsigned int value) { append(std::to_string(value)); }
+    explicit String(long value) { append(std::to_string(value)); }
+    explicit String(unsigned long value) { append(std::to_string(value)); }
+    ~String() { delete[] this->buffer; }
+
+    String & operator=(const String & other) {
+        if(this != &other){
+            this->size = 0;
+            append(other.c_str(), other.size);
+        }
+        return *this;
+    }
+
+    unsigned int length() const { return this->size; }
+    const char * c_str() const { return this->buffer ? this->buffer : ""; }
+    void reserve(unsigned int size) { grow(size); }
+
+    bool concat(const String & value) { append(value.c_str(), value.size); return true; }
+    bool concat(const char * value) { append(value, strlen(value)); return true; }
+    bool concat(char value) { append(&value, 1); return true; }
+    bool concat(unsigned int value) { return concat(String(value)); }
+    bool concat(unsigned long value) { return concat(String(value)); }
+
+    int indexOf(const String & value, unsigned int from = 0) const {
+        const char * found = from <= this->size ? strstr(c_str() + from, value.c_str()) : NULL;
+        return found ? found - c_str() : -1;
+    }
+    String substring(unsigned int from) const { return String(from < this->size ? c_str() + from : ""); }
+    void remove(unsigned int from) {
+        if(from >= this->size) return;
+        this->size = from;
+        this->buffer[from] = '\0';
+    }
+
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return atof(c_str()); }
+
+    bool operator==(const String & other) const { return strcmp(c_str(), other.c_str()) == 0; }
+    bool operator!=(const String & other) const { return !(*this == other); }
+
+  private:
+    char * buffer = NULL;
+    unsigned int size = 0;
+    unsigned int capacity = 0;
+
+    void grow(unsigned int capacity) {
+        if(capacity <= this->capacity) return;
+        char * buffer = new char[capacity + 1];
+        memcpy(buffer, c_str(), this->size + 1);
+        delete[] this->buffer;
+        this->buffer = buffer;
+        this->capacity = capacity;
+    }
+
+    void append(const char * text, unsigned int length) {
+        if(length == 0) return;
+        grow(this->size + length);
+        memmove(this->buffer + this->size, text, length);
+        this->size += length;
+        this->buffer[this->size] = '\0';
+    }
+
+    void append(const std::string & text) {
+        append(text.c_str(), text.size());
+    }
+};
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t * buffer, size_t size) = 0;
+    virtual void flush() {}
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { this->timeout = timeout; }
+
+    // Like the Arduino one: waits up to the timeout for each byte
+    size_t readBytes(char * buffer, size_t length) {
+        size_t count = 0;
+        while(count < length){
+            int c = timedRead();
+            if(c < 0) break;
+            buffer[count++] = (char)c;
+        }
+        return count;
+    }
+
+  protected:
+    unsigned long timeout = 1000;
+
+    int timedRead() {
+        unsigned long start = millis();
+        do {
+            int c = read();
+            if(c >= 0) return c;
+            yield();
+        } while(millis() - start < this->timeout);
+        return -1;
+    }
+};
+
+#endif
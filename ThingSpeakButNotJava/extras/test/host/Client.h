@@ -0,0 +1,20 @@
+/*
+  The Arduino Client interface, as far as the ThingSpeak library uses it.
+
+  See the accompaning licence file for licensing information.
+*/
+
+#ifndef client_h
+#define client_h
+
+#include "Arduino.h"
+
+class Client : public Stream {
+  public:
+    virtual int connect(const char * host, uint16_t port) = 0;
+    virtual uint8_t connected() = 0;
+    virtual void stop() = 0;
+    virtual operator bool() { return connected(); }
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*
+  A Client that plays the ThingSpeak server from a script, see run.sh.
+
+  Each request is answered when the library flushes it: with the next queued response, or, while
+  dropRequests is above zero, by closing the connection without an answer.
+
+  See the accompaning licence file for licensing information.
+*/
+
+#ifndef FakeClient_h
+#define FakeClient_h
+
+#include "Client.h"
+#include <deque>
+#include <string>
+
+class FakeClient : public Client {
+  public:
+    int connects = 0;
+    int stops = 0;
+    int writes = 0;                 // write() calls that reached the server
+    std::string sent;               // every byte written, requests back to back
+    std::deque<std::string> responses;
+    int dropRequests = 0;
+
+    int connect(const char *, uint16_t) override {
+        this->connects++;
+        this->open = true;
+        this->received.clear();
+        this->readPosition = 0;
+        return 1;
+    }
+
+    uint8_t connected() override {
+        return this->open;
+    }
+
+    void stop() override {
+        this->stops++;
+        this->open = false;
+        this->received.clear();
+        this->readPosition = 0;
+    }
+
+    // Room for what a test sends and receives, so that the client itself doesn't allocate meanwhile
+    void reserve(size_t size) {
+        this->sent.reserve(size);
+        this->received.reserve(size);
+    }
+
+    // The server closes an idle connection, the library only notices at its next request
+    void closeByServer() {
+        this->open = false;
+    }
+
+    size_t write(uint8_t value) override {
+        return write(&value, 1);
+    }
+
+    size_t write(const uint8_t * buffer, size_t size) override {
+        if(!this->open) return 0;
+        this->writes++;
+        this->sent.append((const char *)buffer, size);
+        return size;
+    }
+
+    void flush() override {
+        if(!this->open) return;
+        if(this->dropRequests > 0){
+            this->dropRequests--;
+            this->open = false;
+            return;
+        }
+        if(!this->responses.empty()){
+            this->received += this->responses.front();
+            this->responses.pop_front();
+        }
+    }
+
+    int available() override {
+        return this->received.size() - this->readPosition;
+    }
+
+    int read() override {
+        return this->readPosition < this->received.size() ? (uint8_t)this->received[this->readPosition++] : -1;
+    }
+
+    int peek() override {
+        return this->readPosition < this->received.size() ? (uint8_t)this->received[this->readPosition] : -1;
+    }
+
+  private:
+    bool open = false;
+    std::string received;
+    size_t readPosition = 0;
+};
+
+// A ThingSpeak answer with the given body, kept alive unless close is set
+inline std::string response(const std::string & body, bool close = false) {
+    return "HTTP/1.1 200 OK\r\n"
+           "Content-Type: text/plain; charset=utf-8\r\n"
+           + std::string(close ? "Connection: close\r\n" : "Connection: keep-alive\r\n")
+           + "Content-Length: " + std::to_string(body.size()) + "\r\n"
+           "\r\n"
+           + body;
+}
+
+#endif
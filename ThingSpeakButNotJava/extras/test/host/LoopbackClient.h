@@ -0,0 +1,183 @@
+/*
+  A local stand-in for ThingSpeak over real TCP on 127.0.0.1, for timing requests, see run.sh.
+
+  LoopbackServer answers every request with a short body on its own thread, keeping the
+  connection open or closing it after each answer. LoopbackClient is the Client the library
+  talks through, it connects to the server whatever host it is given.
+
+  Loopback itself answers in microseconds, so a link is modelled by its round trip time: the
+  server waits that long before each answer, and connect() waits that long for the TCP handshake
+  (a TLS handshake would add two more round trips).
+
+  See the accompaning licence file for licensing information.
+*/
+
+#ifndef LoopbackClient_h
+#define LoopbackClient_h
+
+#include "Client.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <thread>
+
+class LoopbackServer {
+  public:
+    std::atomic<int> connections{0};
+    std::atomic<int> requests{0};
+
+    LoopbackServer(bool keepAlive, const char * body, unsigned long roundTripMs = 0) : keepAlive(keepAlive), body(body), roundTripMs(roundTripMs) {
+        this->listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(this->listener, (sockaddr *)&address, sizeof(address));
+        socklen_t length = sizeof(address);
+        getsockname(this->listener, (sockaddr *)&address, &length);
+        this->port = ntohs(address.sin_port);
+        listen(this->listener, 4);
+        this->thread = std::thread([this]{ serve(); });
+    }
+
+    ~LoopbackServer() {
+        shutdown(this->listener, SHUT_RDWR);
+        close(this->listener);
+        this->thread.join();
+    }
+
+    uint16_t getPort() {
+        return this->port;
+    }
+
+    unsigned long getRoundTrip() {
+        return this->roundTripMs;
+    }
+
+  private:
+    bool keepAlive;
+    std::string body;
+    unsigned long roundTripMs;
+    int listener;
+    uint16_t port;
+    std::thread thread;
+
+    void serve() {
+        int connection;
+        while((connection = accept(this->listener, NULL, NULL)) >= 0){
+            this->connections++;
+            while(answer(connection) && this->keepAlive){}
+            close(connection);
+        }
+    }
+
+    // Reads one request with its body and answers it, false once the client has gone
+    bool answer(int connection) {
+        std::string request;
+        char buffer[1024];
+        size_t end;
+        while((end = request.find("\r\n\r\n")) == std::string::npos){
+            ssize_t length = recv(connection, buffer, sizeof(buffer), 0);
+            if(length <= 0) return false;
+            request.append(buffer, length);
+        }
+        size_t contentLength = 0;
+        size_t header = request.find("Content-Length: ");
+        if(header != std::string::npos && header < end) contentLength = atol(request.c_str() + header + 16);
+        while(request.size() < end + 4 + contentLength){
+            ssize_t length = recv(connection, buffer, sizeof(buffer), 0);
+            if(length <= 0) return false;
+            request.append(buffer, length);
+        }
+        this->requests++;
+        delay(this->roundTripMs);
+
+        std::string response = "HTTP/1.1 200 OK\r\n"
+                               "Content-Type: text/plain; charset=utf-8\r\n"
+                               + std::string(this->keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n")
+                               + "Content-Length: " + std::to_string(this->body.size()) + "\r\n"
+                               "\r\n"
+                               + this->body;
+        return send(connection, response.data(), response.size(), MSG_NOSIGNAL) == (ssize_t)response.size();
+    }
+};
+
+class LoopbackClient : public Client {
+  public:
+    int writes = 0;
+
+    LoopbackClient(LoopbackServer & server) : server(server) {}
+
+    ~LoopbackClient() {
+        stop();
+    }
+
+    int connect(const char *, uint16_t) override {
+        stop();
+        this->socket = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(this->server.getPort());
+        delay(this->server.getRoundTrip());
+        if(::connect(this->socket, (sockaddr *)&address, sizeof(address)) != 0){
+            stop();
+            return 0;
+        }
+        return 1;
+    }
+
+    uint8_t connected() override {
+        if(this->socket < 0) return 0;
+        // Open until the server has closed its side and everything it sent is read
+        char c;
+        ssize_t length = recv(this->socket, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        return length > 0 || (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+    }
+
+    void stop() override {
+        if(this->socket < 0) return;
+        close(this->socket);
+        this->socket = -1;
+    }
+
+    size_t write(uint8_t value) override {
+        return write(&value, 1);
+    }
+
+    size_t write(const uint8_t * buffer, size_t size) override {
+        if(this->socket < 0) return 0;
+        this->writes++;
+        ssize_t length = send(this->socket, buffer, size, MSG_NOSIGNAL);
+        return length < 0 ? 0 : length;
+    }
+
+    int available() override {
+        if(this->socket < 0) return 0;
+        int length = 0;
+        ioctl(this->socket, FIONREAD, &length);
+        return length;
+    }
+
+    int read() override {
+        uint8_t c;
+        if(this->socket < 0 || recv(this->socket, &c, 1, MSG_DONTWAIT) != 1) return -1;
+        return c;
+    }
+
+    int peek() override {
+        uint8_t c;
+        if(this->socket < 0 || recv(this->socket, &c, 1, MSG_PEEK | MSG_DONTWAIT) != 1) return -1;
+        return c;
+    }
+
+  private:
+    LoopbackServer & server;
+    int socket = -1;
+};
+
+#endif
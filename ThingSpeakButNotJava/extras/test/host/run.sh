@@ -0,0 +1,34 @@
+#!/bin/sh
+# Builds and runs the host tests of the ThingSpeak library with the PC's C++ compiler.
+#
+#   extras/test/host/run.sh                      every test
+#   extras/test/host/run.sh testKeepAlive [...]  one test, the other arguments go to it
+#
+# Arduino.h and Client.h stand in for the Arduino core, FakeClient.h plays the ThingSpeak
+# server from a script and LoopbackClient.h runs one on 127.0.0.1 for timing.
+# Needs a POSIX system; CXX and CXXFLAGS are taken from the environment.
+
+cd "$(dirname "$0")" || exit 1
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2 -Wall}
+BUILD=${TMPDIR:-/tmp}/thingspeak-host-test
+mkdir -p "$BUILD" || exit 1
+
+run() {
+    name=$1
+    shift
+    $CXX -std=gnu++11 $CXXFLAGS -I. -I../../../src -pthread -o "$BUILD/$name" "$name.cpp" ../../../src/ThingSpeak.cpp || return 1
+    "$BUILD/$name" "$@"
+}
+
+if [ $# -gt 0 ]; then
+    run "$@"
+    exit $?
+fi
+
+failed=0
+for test in test*.cpp; do
+    echo "== ${test%.cpp}"
+    run "${test%.cpp}" || failed=1
+done
+exit $failed
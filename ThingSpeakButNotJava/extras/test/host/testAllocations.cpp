@@ -0,0 +1,130 @@
+/*
+  testAllocations host test
+
+  Host test for the heap-free pending write values and last feed of the ThingSpeak Communication
+  Library for Arduino. Every operator new is counted; the String of Arduino.h here allocates through
+  it, so a String made and freed again is counted too. See run.sh.
+
+  See the accompaning licence file for licensing information.
+*/
+
+#include "HostTest.h"
+#include "FakeClient.h"
+#include <ThingSpeak.h>
+#include <new>
+
+static long allocations = 0;
+
+void * operator new(size_t size)
+{
+  allocations++;
+  void * memory = malloc(size ? size : 1);
+  if(memory == NULL) throw std::bad_alloc();
+  return memory;
+}
+
+void operator delete(void * memory) noexcept
+{
+  free(memory);
+}
+
+void operator delete(void * memory, size_t) noexcept
+{
+  free(memory);
+}
+
+unsigned long testChannelNumber = 209617;
+const char * testWriteAPIKey = "514SX5OBP2OFEPL2";
+const char * testReadAPIKey = "D3MJBCYVNFX4Z2A8";
+
+const char * testFeed = "{\"created_at\":\"2017-01-12T13:22:54Z\",\"entry_id\":5,\"field1\":\"21.5\",\"field2\":null,"
+                        "\"field3\":\"text\",\"latitude\":\"42.3\",\"longitude\":null,\"elevation\":null,\"status\":\"hello\"}";
+
+// Writes to the same key are only sent every TS_RATE_LIMIT_MS
+static void skipRateLimit()
+{
+  hostMillisOffset() += TS_RATE_LIMIT_MS;
+}
+
+test(allocationsSteadyStateCase)
+{
+  const int cycles = 10;
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  // Everything the fake server needs is allocated up front
+  client.reserve(1 << 16);
+  for(int i = 0; i <= cycles; i++){
+    client.responses.push_back(response(std::to_string(10 + i)));
+    client.responses.push_back(response(testFeed));
+  }
+
+  // The first cycle connects
+  ts.setField(1, 1);
+  skipRateLimit();
+  assertEqual(TS_OK_SUCCESS, ts.writeFields(testChannelNumber, testWriteAPIKey));
+  assertEqual(TS_OK_SUCCESS, ts.readMultipleFields(testChannelNumber, testReadAPIKey));
+
+  long before = allocations;
+  for(int i = 0; i < cycles; i++){
+    assertEqual(TS_OK_SUCCESS, ts.setField(1, i));
+    assertEqual(TS_OK_SUCCESS, ts.setField(2, (float)i / 3));
+    assertEqual(TS_OK_SUCCESS, ts.setField(3, "text"));
+    assertEqual(TS_OK_SUCCESS, ts.setField(3, "longer text"));
+    assertEqual(TS_OK_SUCCESS, ts.setStatus("status"));
+    ts.setLatitude(42.3f);
+    skipRateLimit();
+    assertEqual(TS_OK_SUCCESS, ts.writeFields(testChannelNumber, testWriteAPIKey));
+    assertEqual(TS_OK_SUCCESS, ts.readMultipleFields(testChannelNumber, testReadAPIKey));
+  }
+  long counted = allocations - before;
+  printf("%ld allocations in %d set, write and read cycles\n", counted, cycles);
+  assertEqual(0L, counted);
+
+  // The values read last are all there
+  assertEqual(String("21.5"), ts.getFieldAsString(1));
+  assertEqual(String(""), ts.getFieldAsString(2));
+  assertEqual(String("text"), ts.getFieldAsString(3));
+  assertEqual(String("hello"), ts.getStatus());
+  assertEqual(String("42.3"), ts.getLatitude());
+  assertEqual(String("2017-01-12T13:22:54Z"), ts.getCreatedAt());
+}
+
+test(allocationsReplaceCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  // Replacing a value in the buffer leaves the others as they were
+  ts.setField(1, "aaa");
+  ts.setField(2, "bbb");
+  ts.setField(1, "c");
+  ts.setStatus("st");
+  ts.setField(2, "");
+
+  client.responses.push_back(response("17"));
+  skipRateLimit();
+  assertEqual(TS_OK_SUCCESS, ts.writeFields(testChannelNumber, testWriteAPIKey));
+  assertTrue(client.sent.find("\r\n\r\nfield1=c&status=st&headers=false") != std::string::npos);
+}
+
+test(allocationsFullBufferCase)
+{
+  ThingSpeakClass ts;
+
+  // A value may be 255 bytes, the buffer refuses the first one that doesn't fit
+  std::string value(250, 'x');
+  int status = TS_OK_SUCCESS;
+  for(int field = 1; field <= 8 && status == TS_OK_SUCCESS; field++){
+    status = ts.setField(field, value.c_str());
+  }
+  assertEqual(TS_ERR_OUT_OF_RANGE, status);
+  assertEqual(TS_ERR_OUT_OF_RANGE, ts.setField(1, std::string(256, 'y').c_str()));
+}
+
+int main()
+{
+  return HostTest::runTests();
+}
@@ -0,0 +1,207 @@
+/*
+  testFloatFormat host test
+
+  Host test for the integer float formatting of the ThingSpeak Communication Library for Arduino.
+  Checks convertFloatToChar() against an exact reference and times it against snprintf and dtostrf.
+
+    run.sh testFloatFormat                         known values, every 4096th float, timing
+    run.sh testFloatFormat exhaustive [decimals]   every float of the supported range, for one or all precisions
+
+  The exhaustive run covers 1.4e9 floats per precision and takes a few minutes each.
+
+  See the accompaning licence file for licensing information.
+*/
+
+#include "HostTest.h"
+#include "FakeClient.h"
+#include <ThingSpeak.h>
+
+unsigned long testChannelNumber = 209617;
+const char * testWriteAPIKey = "514SX5OBP2OFEPL2";
+
+// Exact: value * 10^decimals fits a long double (24 + 17 bits), halves go away from zero, zeros are trimmed
+static void reference(float value, unsigned int decimals, char * text)
+{
+  static const long double powers[] = {1, 10, 100, 1000, 10000, 100000};
+  unsigned long long scaled = (unsigned long long)floorl(fabsl((long double)value) * powers[decimals] + 0.5L);
+  while(decimals > 0 && scaled % 10 == 0){
+    scaled /= 10;
+    decimals--;
+  }
+
+  char digits[40];
+  int length = sprintf(digits, "%0*llu", decimals + 1, scaled);
+  if(value < 0 && scaled != 0) *text++ = '-';
+  memcpy(text, digits, length - decimals);
+  text += length - decimals;
+  if(decimals > 0){
+    *text++ = '.';
+    memcpy(text, digits + length - decimals, decimals);
+    text += decimals;
+  }
+  *text = '\0';
+}
+
+// snprintf with the zeros trimmed, to check the reference itself
+static void trimmed(float value, unsigned int decimals, char * text)
+{
+  sprintf(text, "%.*f", decimals, value);
+  if(strchr(text, '.') != NULL){
+    char * end = text + strlen(text) - 1;
+    while(*end == '0') *end-- = '\0';
+    if(*end == '.') *end = '\0';
+  }
+  if(strcmp(text, "-0") == 0) strcpy(text, "0");
+}
+
+struct Sweep {
+  unsigned long long floats = 0;
+  unsigned long long nearHalf = 0;
+  unsigned long long referenceChecks = 0;
+};
+
+// Below 2^-8 the 32 bit fraction loses bits, so only values within 2^-32 of a half may round the other way
+static bool nearHalf(float value, unsigned int decimals)
+{
+  long double scaled = fabsl((long double)value) * powl(10, decimals);
+  return value < 0.00390625f && fabsl(scaled - floorl(scaled) - 0.5L) < powl(10, decimals) * ldexpl(1, -32);
+}
+
+// Every float from 0 to 999999000000 whose bits are a multiple of step, the negative ones on every 4096th
+static bool sweep(unsigned int decimals, uint32_t step, Sweep & result)
+{
+  char mine[32], exact[32];
+  uint32_t top;
+  float largest = 999999000000.0f;
+  memcpy(&top, &largest, sizeof(top));
+
+  for(uint32_t bits = 0; bits <= top; bits += step){
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    result.floats++;
+
+    ThingSpeakClass::convertFloatToChar(value, mine, decimals);
+    reference(value, decimals, exact);
+    if(strcmp(mine, exact) != 0){
+      if(!nearHalf(value, decimals)){
+        printf("%a with %u decimals: %s, exact %s\n", value, decimals, mine, exact);
+        return false;
+      }
+      result.nearHalf++;
+    }
+
+    if(bits % 4096 == 0){
+      result.referenceChecks++;
+      trimmed(value, decimals, mine);
+      long double scaled = (long double)value * powl(10, decimals);
+      if(strcmp(mine, exact) != 0 && scaled - floorl(scaled) != 0.5L){
+        printf("%a with %u decimals: reference %s, snprintf %s\n", value, decimals, exact, mine);
+        return false;
+      }
+      ThingSpeakClass::convertFloatToChar(-value, mine, decimals);
+      reference(-value, decimals, exact);
+      if(strcmp(mine, exact) != 0 && !nearHalf(value, decimals)){
+        printf("%a with %u decimals: %s, exact %s\n", -value, decimals, mine, exact);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+test(floatFormatKnownValuesCase)
+{
+  struct { float value; unsigned int decimals; const char * text; } known[] = {
+    {1013.25f, 5, "1013.25"}, {5, 5, "5"}, {-0.000001f, 5, "0"}, {-0.0f, 5, "0"}, {0.5f, 0, "1"}, {-2.5f, 0, "-3"},
+    {3.14159f, 5, "3.14159"}, {21.456f, 2, "21.46"}, {0.1f, 1, "0.1"}, {0.99999f, 4, "1"},
+    {999999000000.0f, 5, "999999012864"}, {NAN, 5, "nan"}, {INFINITY, 5, "inf"}, {-INFINITY, 5, "-inf"}
+  };
+  char text[32];
+  for(auto & value : known){
+    assertEqual(TS_OK_SUCCESS, ThingSpeakClass::convertFloatToChar(value.value, text, value.decimals));
+    if(strcmp(text, value.text) != 0) printf("%g with %u decimals: %s, expected %s\n", value.value, value.decimals, text, value.text);
+    assertEqual(0, strcmp(text, value.text));
+  }
+}
+
+test(floatFormatRangeCase)
+{
+  char text[32];
+  assertEqual(TS_ERR_OUT_OF_RANGE, ThingSpeakClass::convertFloatToChar(1e13f, text));
+  assertEqual(TS_ERR_OUT_OF_RANGE, ThingSpeakClass::convertFloatToChar(-1e13f, text));
+  assertEqual(TS_ERR_OUT_OF_RANGE, ThingSpeakClass::convertFloatToChar(1, text, TS_FLOAT_DECIMALS_MAX + 1));
+}
+
+test(floatFormatPrecisionCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  assertEqual(TS_OK_SUCCESS, ts.setFieldPrecision(2, 1));
+  assertEqual(TS_ERR_INVALID_FIELD_NUM, ts.setFieldPrecision(9, 1));
+  assertEqual(TS_ERR_OUT_OF_RANGE, ts.setFieldPrecision(1, TS_FLOAT_DECIMALS_MAX + 1));
+
+  ts.setField(1, 1013.25f);
+  ts.setField(2, 21.46f);
+  client.responses.push_back(response("17"));
+  assertEqual(TS_OK_SUCCESS, ts.writeFields(testChannelNumber, testWriteAPIKey));
+  assertTrue(client.sent.find("field1=1013.25&field2=21.5&") != std::string::npos);
+}
+
+test(floatFormatSampleCase)
+{
+  for(unsigned int decimals = 0; decimals <= TS_FLOAT_DECIMALS_MAX; decimals++){
+    Sweep result;
+    assertTrue(sweep(decimals, 4096, result));
+  }
+}
+
+test(floatFormatSpeedCase)
+{
+  const int values = 1000000;
+  char text[32];
+  volatile char sink = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < values; i++){
+    ThingSpeakClass::convertFloatToChar(0.0123f + i * 0.37f, text);
+    sink = sink + text[0];
+  }
+  auto formatted = std::chrono::steady_clock::now();
+  for(int i = 0; i < values; i++){
+    snprintf(text, sizeof(text), "%.5f", 0.0123f + i * 0.37f);
+    sink = sink + text[0];
+  }
+  auto printed = std::chrono::steady_clock::now();
+  for(int i = 0; i < values; i++){
+    dtostrf(0.0123f + i * 0.37f, 1, 5, text);
+    sink = sink + text[0];
+  }
+  auto converted = std::chrono::steady_clock::now();
+
+  auto nanos = [&](std::chrono::steady_clock::duration time){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() / values;
+  };
+  printf("Per value: convertFloatToChar %ld ns, snprintf %ld ns, dtostrf (host stand-in on sprintf) %ld ns\n",
+         (long)nanos(formatted - start), (long)nanos(printed - formatted), (long)nanos(converted - printed));
+}
+
+int main(int argc, char ** argv)
+{
+  if(argc < 2) return HostTest::runTests();
+
+  if(strcmp(argv[1], "exhaustive") != 0){
+    printf("Usage: %s [exhaustive [decimals]]\n", argv[0]);
+    return 1;
+  }
+  unsigned int first = argc > 2 ? atoi(argv[2]) : 0;
+  unsigned int last = argc > 2 ? first : TS_FLOAT_DECIMALS_MAX;
+  for(unsigned int decimals = first; decimals <= last; decimals++){
+    Sweep result;
+    if(!sweep(decimals, 1, result)) return 1;
+    printf("%u decimals: %llu floats, %llu within 2^-32 of a half below 2^-8, reference checked against snprintf %llu times\n",
+           decimals, result.floats, result.nearHalf, result.referenceChecks);
+  }
+  return 0;
+}
@@ -0,0 +1,187 @@
+/*
+  testKeepAlive host test
+
+  Host test for connection reuse (HTTP keep-alive) in the ThingSpeak Communication Library for Arduino.
+  The server is played by FakeClient, the timing at the end runs against LoopbackServer. See run.sh.
+
+  See the accompaning licence file for licensing information.
+*/
+
+#include "HostTest.h"
+#include "FakeClient.h"
+#include "LoopbackClient.h"
+#include <ThingSpeak.h>
+
+unsigned long testChannelNumber = 209617;
+const char * testWriteAPIKey = "514SX5OBP2OFEPL2";
+const char * testReadAPIKey = "D3MJBCYVNFX4Z2A8";
+
+// Writes to the same key are only sent every TS_RATE_LIMIT_MS
+static void skipRateLimit()
+{
+  hostMillisOffset() += TS_RATE_LIMIT_MS;
+}
+
+static int count(const std::string & text, const char * what)
+{
+  int found = 0;
+  for(size_t at = text.find(what); at != std::string::npos; at = text.find(what, at + 1)) found++;
+  return found;
+}
+
+test(keepAliveReuseCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  client.responses.push_back(response("21.5"));
+  assertEqual(String("21.5"), ts.readStringField(testChannelNumber, 1, testReadAPIKey));
+  assertTrue(client.connected());
+
+  // The read and the write after it go out on the same connection
+  client.responses.push_back(response("17"));
+  skipRateLimit();
+  assertEqual(TS_OK_SUCCESS, ts.writeField(testChannelNumber, 1, 5, testWriteAPIKey));
+  client.responses.push_back(response("21.5"));
+  assertEqual(String("21.5"), ts.readStringField(testChannelNumber, 1, testReadAPIKey));
+
+  assertEqual(1, client.connects);
+  assertEqual(0, client.stops);
+  assertEqual(3, count(client.sent, "Connection: keep-alive\r\n"));
+}
+
+test(keepAliveServerClosedCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  client.responses.push_back(response("21.5"));
+  assertEqual(String("21.5"), ts.readStringField(testChannelNumber, 1, testReadAPIKey));
+
+  // Closed while idle: noticed before sending, so the request goes out once on a new connection
+  client.closeByServer();
+  client.responses.push_back(response("22.5"));
+  assertEqual(String("22.5"), ts.readStringField(testChannelNumber, 1, testReadAPIKey));
+  assertEqual(2, client.connects);
+  assertEqual(2, count(client.sent, "GET "));
+}
+
+test(keepAliveRetryCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  client.responses.push_back(response("21.5"));
+  assertEqual(String("21.5"), ts.readStringField(testChannelNumber, 1, testReadAPIKey));
+
+  // Closed after the request went out on the kept connection: sent once more on a new one
+  client.dropRequests = 1;
+  client.responses.push_back(response("18"));
+  skipRateLimit();
+  assertEqual(TS_OK_SUCCESS, ts.writeField(testChannelNumber, 1, 6, testWriteAPIKey));
+  assertEqual(2, client.connects);
+  assertEqual(2, count(client.sent, "POST "));
+
+  client.dropRequests = 1;
+  client.responses.push_back(response("22.5"));
+  assertEqual(String("22.5"), ts.readStringField(testChannelNumber, 1, testReadAPIKey));
+  assertEqual(TS_OK_SUCCESS, ts.getLastReadStatus());
+  assertEqual(3, client.connects);
+
+  // Only once: a new connection closed without an answer is an error
+  client.dropRequests = 2;
+  skipRateLimit();
+  assertEqual(TS_ERR_CONNECTION_CLOSED, ts.writeField(testChannelNumber, 1, 7, testWriteAPIKey));
+  assertEqual(4, client.connects);
+  assertEqual(4, count(client.sent, "POST "));
+}
+
+test(keepAliveConnectionCloseCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  // The server says it closes, the library lets go of the connection
+  client.responses.push_back(response("17", true));
+  skipRateLimit();
+  assertEqual(TS_OK_SUCCESS, ts.writeField(testChannelNumber, 1, 5, testWriteAPIKey));
+  assertFalse(client.connected());
+  assertEqual(1, client.stops);
+
+  // HTTP/1.0 without a Connection header closes as well
+  client.responses.push_back("HTTP/1.0 200 OK\r\nContent-Length: 4\r\n\r\n21.5");
+  assertEqual(String("21.5"), ts.readStringField(testChannelNumber, 1, testReadAPIKey));
+  assertFalse(client.connected());
+  assertEqual(2, client.connects);
+
+  // The next request connects again
+  client.responses.push_back(response("21.5"));
+  assertEqual(String("21.5"), ts.readStringField(testChannelNumber, 1, testReadAPIKey));
+  assertTrue(client.connected());
+  assertEqual(3, client.connects);
+}
+
+test(keepAliveNoContentLengthCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  // Without Content-Length the end of the body is unknown, the connection can't be used again
+  client.responses.push_back("HTTP/1.1 200 OK\r\nConnection: keep-alive\r\n\r\n21.5");
+  assertEqual(String(""), ts.readStringField(testChannelNumber, 1, testReadAPIKey));
+  assertEqual(TS_ERR_BAD_RESPONSE, ts.getLastReadStatus());
+  assertFalse(client.connected());
+
+  client.responses.push_back("HTTP/1.1 200 OK\r\nConnection: keep-alive\r\n\r\n17");
+  skipRateLimit();
+  assertEqual(TS_ERR_BAD_RESPONSE, ts.writeField(testChannelNumber, 1, 5, testWriteAPIKey));
+  assertFalse(client.connected());
+
+  client.responses.push_back(response("21.5"));
+  assertEqual(String("21.5"), ts.readStringField(testChannelNumber, 1, testReadAPIKey));
+  assertEqual(3, client.connects);
+}
+
+// Reads over a link with a 20 ms round trip, once kept alive and once closed after every answer
+static unsigned long timeReads(bool keepAlive, int & connections)
+{
+  const int reads = 10;
+  LoopbackServer server(keepAlive, "21.5", 20);
+  LoopbackClient client(server);
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  unsigned long start = millis();
+  for(int i = 0; i < reads; i++){
+    if(ts.readStringField(testChannelNumber, 1, testReadAPIKey) != String("21.5")) return 0;
+  }
+  unsigned long perRead = (millis() - start) / reads;
+  client.stop();
+  connections = server.connections;
+  return perRead;
+}
+
+test(keepAliveLoopbackCase)
+{
+  int keptConnections = 0, closedConnections = 0;
+  unsigned long kept = timeReads(true, keptConnections);
+  unsigned long closed = timeReads(false, closedConnections);
+  printf("Loopback, 20 ms round trip: %lu ms per read kept alive (%d connection), %lu ms closed (%d connections)\n",
+         kept, keptConnections, closed, closedConnections);
+
+  assertNotEqual(0UL, kept);
+  assertNotEqual(0UL, closed);
+  assertEqual(1, keptConnections);
+  assertEqual(10, closedConnections);
+  assertTrue(kept < closed);
+}
+
+int main()
+{
+  return HostTest::runTests();
+}
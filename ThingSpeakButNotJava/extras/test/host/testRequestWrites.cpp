@@ -0,0 +1,245 @@
+/*
+  testRequestWrites host test
+
+  Host test for sending each request of the ThingSpeak Communication Library for Arduino in as few
+  writes as possible: one when it fits its buffer, a few when the headers don't fit in front of the body. The timing at
+  the end runs against LoopbackServer. See run.sh.
+
+  See the accompaning licence file for licensing information.
+*/
+
+#include "HostTest.h"
+#include "FakeClient.h"
+#include "LoopbackClient.h"
+#include <ThingSpeak.h>
+
+unsigned long testChannelNumber = 209617;
+const char * testWriteAPIKey = "514SX5OBP2OFEPL2";
+const char * testReadAPIKey = "D3MJBCYVNFX4Z2A8";
+
+// Writes to the same key are only sent every TS_RATE_LIMIT_MS
+static void skipRateLimit()
+{
+  hostMillisOffset() += TS_RATE_LIMIT_MS;
+}
+
+// The body of the last request sent, checked against its Content-Length
+static bool lastBodyComplete(const std::string & sent)
+{
+  size_t request = sent.rfind("POST ");
+  size_t header = sent.find("Content-Length: ", request);
+  size_t body = sent.find("\r\n\r\n", request);
+  if(request == std::string::npos || header == std::string::npos || body == std::string::npos) return false;
+  return sent.size() - (body + 4) == (size_t)atol(sent.c_str() + header + 16);
+}
+
+test(writeFieldsWritesCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  for(int field = 1; field <= 8; field++){
+    assertEqual(TS_OK_SUCCESS, ts.setField(field, (float)field * 1.25f));
+  }
+  ts.setStatus("All eight fields");
+  ts.setLatitude(42.3f);
+  ts.setLongitude(-71.35f);
+  ts.setCreatedAt("2017-01-12 13:22:54");
+
+  client.responses.push_back(response("17"));
+  skipRateLimit();
+  int writes = client.writes;
+  assertEqual(TS_OK_SUCCESS, ts.writeFields(testChannelNumber, testWriteAPIKey));
+  assertEqual(1, client.writes - writes);
+  assertTrue(lastBodyComplete(client.sent));
+}
+
+test(writeFieldWritesCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  client.responses.push_back(response("17"));
+  skipRateLimit();
+  assertEqual(TS_OK_SUCCESS, ts.writeField(testChannelNumber, 1, 21.5f, testWriteAPIKey));
+  assertEqual(1, client.writes);
+
+  client.responses.push_back(response("18"));
+  skipRateLimit();
+  assertEqual(TS_OK_SUCCESS, ts.writeRaw(testChannelNumber, String("field1=1&field2=2"), testWriteAPIKey));
+  assertEqual(2, client.writes);
+  assertTrue(lastBodyComplete(client.sent));
+}
+
+test(readWritesCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  client.responses.push_back(response("21.5"));
+  assertEqual(String("21.5"), ts.readStringField(testChannelNumber, 1, testReadAPIKey));
+  assertEqual(1, client.writes);
+
+  client.responses.push_back(response("{\"created_at\":\"2017-01-12T13:22:54Z\",\"entry_id\":5,\"field1\":\"21.5\"}"));
+  assertEqual(TS_OK_SUCCESS, ts.readMultipleFields(testChannelNumber, testReadAPIKey));
+  assertEqual(2, client.writes);
+}
+
+test(bulkWritesCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  ts.setField(1, 1);
+  assertEqual(TS_OK_SUCCESS, ts.addBulkEntry(0UL));
+  ts.setField(1, 2);
+  ts.setLatitude(42.36789f);
+  ts.setElevation(-12.5f);
+  assertEqual(TS_OK_SUCCESS, ts.addBulkEntry(15UL));
+
+  client.responses.push_back("HTTP/1.1 202 Accepted\r\nContent-Length: 18\r\n\r\n{\"success\":true}\r\n");
+  skipRateLimit();
+  assertEqual(TS_OK_SUCCESS, ts.writeBulk(testChannelNumber, testWriteAPIKey));
+  assertEqual(1, client.writes);
+  assertTrue(lastBodyComplete(client.sent));
+
+  // The location has 2 decimals like in writeFields()
+  assertTrue(client.sent.find(",\"field1\":\"2\",\"latitude\":42.37,\"elevation\":-12.5}") != std::string::npos);
+}
+
+test(bulkKeyCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  // The bulk update has no default key, none at all is refused before anything is sent
+  ts.setField(1, 1);
+  assertEqual(TS_OK_SUCCESS, ts.addBulkEntry(0UL));
+  assertEqual(TS_ERR_BADAPIKEY, ts.writeBulk(testChannelNumber, NULL));
+  assertEqual(TS_ERR_BADAPIKEY, ts.writeBulk(testChannelNumber, ""));
+  assertEqual(0, client.writes);
+
+  // The key goes into the JSON body escaped like the values
+  client.responses.push_back("HTTP/1.1 202 Accepted\r\nContent-Length: 18\r\n\r\n{\"success\":true}\r\n");
+  skipRateLimit();
+  assertEqual(TS_OK_SUCCESS, ts.writeBulk(testChannelNumber, "AB\"C\\D\n"));
+  assertTrue(client.sent.find("{\"write_api_key\":\"AB\\\"C\\\\D\\u000a\",\"updates\":[") != std::string::npos);
+  assertTrue(lastBodyComplete(client.sent));
+}
+
+test(longBodyWritesCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  // About 800 bytes of body still leave together with the headers
+  std::string value(95, 'x');
+  for(int field = 1; field <= 8; field++){
+    assertEqual(TS_OK_SUCCESS, ts.setField(field, value.c_str()));
+  }
+
+  client.responses.push_back(response("17"));
+  skipRateLimit();
+  assertEqual(TS_OK_SUCCESS, ts.writeFields(testChannelNumber, testWriteAPIKey));
+  assertEqual(1, client.writes);
+  assertTrue(lastBodyComplete(client.sent));
+
+  // A full write buffer leaves too little room for the headers in front of the body, they go first
+  value.assign(125, 'y');
+  for(int field = 1; field <= 8; field++){
+    assertEqual(TS_OK_SUCCESS, ts.setField(field, value.c_str()));
+  }
+
+  client.responses.push_back(response("18"));
+  skipRateLimit();
+  assertEqual(TS_OK_SUCCESS, ts.writeFields(testChannelNumber, testWriteAPIKey));
+  assertTrue(client.writes - 1 > 1);
+  assertTrue(client.writes - 1 <= 3);
+  assertTrue(lastBodyComplete(client.sent));
+}
+
+test(writeTemplateWritesCase)
+{
+  FakeClient client;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  // The most negative values take the most room in the body on the stack, whatever width long has here
+  client.responses.push_back(response("17"));
+  skipRateLimit();
+  int status = ts.write<1, 2>(testChannelNumber, testWriteAPIKey, LONG_MIN, INT_MIN);
+  assertEqual(TS_OK_SUCCESS, status);
+  assertEqual(1, client.writes);
+  assertTrue(lastBodyComplete(client.sent));
+  std::string body = "field1=" + std::to_string(LONG_MIN) + "&field2=" + std::to_string(INT_MIN) + "&headers=false";
+  assertTrue(client.sent.find("\r\n\r\n" + body) != std::string::npos);
+}
+
+// Splits every write into 8 byte pieces, about what the print() per request part used to give
+class PiecewiseClient : public LoopbackClient {
+  public:
+    PiecewiseClient(LoopbackServer & server) : LoopbackClient(server) {}
+
+    size_t write(const uint8_t * buffer, size_t size) override {
+        size_t written = 0;
+        while(written < size){
+            size_t length = min(size - written, (size_t)8);
+            if(LoopbackClient::write(buffer + written, length) != length) break;
+            written += length;
+        }
+        return written;
+    }
+};
+
+// Microseconds per writeFields() over loopback, and the writes it took
+static unsigned long timeWrites(LoopbackClient & client, int & writes)
+{
+  const int requests = 50;
+  ThingSpeakClass ts;
+  ts.begin(client);
+
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < requests; i++){
+    for(int field = 1; field <= 4; field++) ts.setField(field, i + field);
+    ts.setStatus("Loopback");
+    skipRateLimit();
+    if(ts.writeFields(testChannelNumber, testWriteAPIKey) != TS_OK_SUCCESS) return 0;
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  writes = client.writes / requests;
+  client.stop();
+  return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / requests;
+}
+
+test(requestWritesLoopbackCase)
+{
+  int whole = 0, piecewise = 0;
+  unsigned long wholeMicros, piecewiseMicros;
+  {
+    LoopbackServer server(true, "17");
+    LoopbackClient client(server);
+    wholeMicros = timeWrites(client, whole);
+  }
+  {
+    LoopbackServer server(true, "17");
+    PiecewiseClient client(server);
+    piecewiseMicros = timeWrites(client, piecewise);
+  }
+  printf("Loopback: %lu us per writeFields() in %d write(s), %lu us in %d writes of 8 bytes\n",
+         wholeMicros, whole, piecewiseMicros, piecewise);
+
+  assertNotEqual(0UL, wholeMicros);
+  assertNotEqual(0UL, piecewiseMicros);
+  assertEqual(1, whole);
+}
+
+int main()
+{
+  return HostTest::runTests();
+}
@@ -70,6 +70,24 @@ test(beginCase)
   assertEqual(TS_OK_SUCCESS, ThingSpeak.writeField(testChannelNumber, FIELD1, val, testChannelWriteAPIKey));
 }
 
+test(instancesCase) 
+{
+  // A second instance keeps its own values
+  ThingSpeakClass other;
+  assertTrue(ThingSpeak.begin(client));
+  assertTrue(other.begin(client));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(FIELD1, 25));
+  assertEqual(TS_ERR_SETFIELD_NOT_CALLED, other.writeFields(testChannelNumber, testChannelWriteAPIKey));
+
+  // Always wait to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeFields(testChannelNumber, testChannelWriteAPIKey));
+
+  // The rate limit window of a key is shared, the other instance has to wait for it as well
+  assertEqual(TS_OK_SUCCESS, other.setField(FIELD1, 26));
+  assertEqual(TS_ERR_NOT_INSERTED, other.writeFields(testChannelNumber, testChannelWriteAPIKey));
+}
+
 void setup()
 {
   Serial.begin(9600);
@@ -0,0 +1,116 @@
+#line 2 "testFloatFormat.ino"
+/*
+  testFloatFormat unit test
+  
+  Unit Test for the float formatting in the ThingSpeak Communication Library for Arduino
+  
+  This test use the ArduinoUnit 2.1.0 unit test framework.  Visit https://github.com/mmurdoch/arduinounit to learn more.
+  
+  ArduinoUnit does not support ESP8266 or ESP32 and therefor these tests will not compile for those platforms.
+  
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and 
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.  
+  
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+  
+  For licensing information, see the accompanying license file.
+  
+  Copyright 2018, The MathWorks, Inc.
+*/
+
+// Runs without a network, only the formatting is tested
+
+#include <ArduinoUnit.h>
+#include <ThingSpeak.h> // always include thingspeak header file after other header files and custom macros
+
+char valueString[20];
+
+test(floatFormatTrimCase)
+{
+  // Trailing zeros are left out, the default are 5 decimals
+  assertEqual(TS_OK_SUCCESS, ThingSpeakClass::convertFloatToChar(1013.25, valueString));
+  assertEqual("1013.25", valueString);
+  assertEqual(TS_OK_SUCCESS, ThingSpeakClass::convertFloatToChar(5.0, valueString));
+  assertEqual("5", valueString);
+  assertEqual(TS_OK_SUCCESS, ThingSpeakClass::convertFloatToChar(3.14159, valueString));
+  assertEqual("3.14159", valueString);
+  assertEqual(TS_OK_SUCCESS, ThingSpeakClass::convertFloatToChar(-0.000001, valueString));
+  assertEqual("0", valueString);
+}
+
+test(floatFormatPrecisionCase)
+{
+  // Halves are rounded away from zero
+  assertEqual(TS_OK_SUCCESS, ThingSpeakClass::convertFloatToChar(21.456, valueString, 2));
+  assertEqual("21.46", valueString);
+  assertEqual(TS_OK_SUCCESS, ThingSpeakClass::convertFloatToChar(-2.5, valueString, 0));
+  assertEqual("-3", valueString);
+  assertEqual(TS_OK_SUCCESS, ThingSpeakClass::convertFloatToChar(0.99999, valueString, 4));
+  assertEqual("1", valueString);
+  assertEqual(TS_ERR_OUT_OF_RANGE, ThingSpeakClass::convertFloatToChar(1.0, valueString, 6));
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setFieldPrecision(1, 1));
+  assertEqual(TS_ERR_OUT_OF_RANGE, ThingSpeak.setFieldPrecision(1, 6));
+  assertEqual(TS_ERR_INVALID_FIELD_NUM, ThingSpeak.setFieldPrecision(0, 1));
+  assertEqual(TS_ERR_INVALID_FIELD_NUM, ThingSpeak.setFieldPrecision(9, 1));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setFieldPrecision(1, TS_FLOAT_DECIMALS));
+}
+
+test(floatFormatRangeCase)
+{
+  assertEqual(TS_OK_SUCCESS, ThingSpeakClass::convertFloatToChar(NAN, valueString));
+  assertEqual("nan", valueString);
+  assertEqual(TS_OK_SUCCESS, ThingSpeakClass::convertFloatToChar(-INFINITY, valueString));
+  assertEqual("-inf", valueString);
+  assertEqual(TS_OK_SUCCESS, ThingSpeakClass::convertFloatToChar(-999999000000, valueString));
+  assertEqual(TS_ERR_OUT_OF_RANGE, ThingSpeakClass::convertFloatToChar(1000000000000, valueString));
+}
+
+test(floatFormatRoundTripCase)
+{
+  // Read back, every value is within half a unit of the last decimal
+  for(long i = -100000; i <= 100000; i += 7){
+    float value = i / 997.0;
+    for(unsigned int decimals = 0; decimals <= TS_FLOAT_DECIMALS_MAX; decimals++){
+      assertEqual(TS_OK_SUCCESS, ThingSpeakClass::convertFloatToChar(value, valueString, decimals));
+      float limit = 0.5 * pow(10, -(int)decimals) + fabs(value) * 1e-6;
+      assertLessOrEqual(fabs(atof(valueString) - value), limit);
+    }
+  }
+}
+
+test(floatFormatSpeedCase)
+{
+  // Compare with the formatting used before
+  unsigned long start = micros();
+  for(int i = 0; i < 1000; i++){
+    ThingSpeakClass::convertFloatToChar(i * 1.37, valueString);
+  }
+  unsigned long formatted = micros() - start;
+
+  start = micros();
+  for(int i = 0; i < 1000; i++){
+    #if defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_ARCH_SAM)
+      sprintf(valueString, "%.5f", i * 1.37);
+    #else
+      dtostrf(i * 1.37, 1, 5, valueString);
+    #endif
+  }
+  unsigned long printed = micros() - start;
+
+  Serial.print("convertFloatToChar: "); Serial.print(formatted); Serial.print(" us, dtostrf/sprintf: "); Serial.print(printed); Serial.println(" us for 1000 values");
+  assertLess(formatted, printed);
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+  Serial.println("Starting test...");
+}
+
+void loop()
+{
+  Test::run();
+}
@@ -0,0 +1,107 @@
+#line 2 "testKeepAlive.ino"
+/*
+  testKeepAlive unit test
+  
+  Unit Test for connection reuse (HTTP keep-alive) in the ThingSpeak Communication Library for Arduino
+  
+  This test use the ArduinoUnit 2.1.0 unit test framework.  Visit https://github.com/mmurdoch/arduinounit to learn more.
+  
+  ArduinoUnit does not support ESP8266 or ESP32 and therefor these tests will not compile for those platforms.
+  
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and 
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.  
+  
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+  
+  For licensing information, see the accompanying license file.
+  
+  Copyright 2018, The MathWorks, Inc.
+*/
+
+//#define USE_WIFI101_SHIELD
+//#define USE_ETHERNET_SHIELD
+
+#if !defined(USE_WIFI101_SHIELD) && !defined(USE_ETHERNET_SHIELD) && !defined(ARDUINO_SAMD_MKR1000) && !defined(ARDUINO_AVR_YUN)
+  #error "Uncomment the #define for either USE_WIFI101_SHIELD or USE_ETHERNET_SHIELD"
+#endif
+
+#include <ArduinoUnit.h>
+
+#if defined(ARDUINO_AVR_YUN)
+    #include "YunClient.h"
+    YunClient client;
+#else
+  #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+    // Use WiFi  
+    #include <SPI.h>
+    #include <WiFi101.h>
+    char ssid[] = "<YOURNETWORK>";    //  your network SSID (name) 
+    char pass[] = "<YOURPASSWORD>";   // your network password   
+    int status = WL_IDLE_STATUS;
+    WiFiClient  client;
+  #elif defined(USE_ETHERNET_SHIELD)
+    // Use wired ethernet shield
+    #include <SPI.h>
+    #include <Ethernet.h>
+    byte mac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED};
+    EthernetClient client;
+  #endif
+#endif
+
+#include <ThingSpeak.h> // always include thingspeak header file after other header files and custom macros
+
+unsigned long testPublicChannelNumber = 209617;
+const char * testPublicChannelWriteAPIKey = "514SX5OBP2OFEPL2";
+
+unsigned long testPrivateChannelNumber = 209615;
+const char * testPrivateChannelReadAPIKey = "D3MJBCYVNFX4Z2A8";
+const char * testPrivateChannelWriteAPIKey = "KI8B7DJTWXLZ6EBV";
+
+#define WRITE_DELAY_FOR_THINGSPEAK 15000
+
+test(keepAliveReadCase)
+{
+  // The first read opens the connection, the server keeps it open afterwards
+  assertNotEqual(0.0,ThingSpeak.readFloatField(testPrivateChannelNumber, 1, testPrivateChannelReadAPIKey));
+  assertEqual(TS_OK_SUCCESS,ThingSpeak.getLastReadStatus());
+  assertTrue(client.connected());
+
+  // The second read goes out on the same connection
+  assertNotEqual(0.0,ThingSpeak.readFloatField(testPrivateChannelNumber, 1, testPrivateChannelReadAPIKey));
+  assertEqual(TS_OK_SUCCESS,ThingSpeak.getLastReadStatus());
+  assertTrue(client.connected());
+}
+
+test(keepAliveReconnectCase)
+{
+  // Always wait 15 seconds to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+
+  // Drop the connection behind the library's back, the next write has to reconnect on its own
+  client.stop();
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeField(testPrivateChannelNumber, 1, (float)1.0, testPrivateChannelWriteAPIKey));
+  assertTrue(client.connected());
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+  Serial.println("Starting test...");
+  #ifdef ARDUINO_AVR_YUN
+    Bridge.begin();
+  #else   
+    #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+      WiFi.begin(ssid, pass);
+    #else
+      Ethernet.begin(mac);
+    #endif
+  #endif
+  ThingSpeak.begin(client);
+}
+
+void loop()
+{
+  Test::run();
+}
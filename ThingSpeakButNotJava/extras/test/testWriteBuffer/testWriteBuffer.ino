@@ -0,0 +1,145 @@
+#line 2 "testWriteBuffer.ino"
+/*
+  testWriteBuffer unit test
+  
+  Unit Test for the heap-free storage of pending values in the ThingSpeak Communication Library for Arduino
+  
+  This test use the ArduinoUnit 2.1.0 unit test framework.  Visit https://github.com/mmurdoch/arduinounit to learn more.
+  
+  ArduinoUnit does not support ESP8266 or ESP32 and therefor these tests will not compile for those platforms.
+  
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and 
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.  
+  
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+  
+  For licensing information, see the accompanying license file.
+  
+  Copyright 2018, The MathWorks, Inc.
+*/
+
+//#define USE_WIFI101_SHIELD
+//#define USE_ETHERNET_SHIELD
+
+#if !defined(USE_WIFI101_SHIELD) && !defined(USE_ETHERNET_SHIELD) && !defined(ARDUINO_SAMD_MKR1000) && !defined(ARDUINO_AVR_YUN)
+  #error "Uncomment the #define for either USE_WIFI101_SHIELD or USE_ETHERNET_SHIELD"
+#endif
+
+#include <ArduinoUnit.h>
+
+#if defined(ARDUINO_AVR_YUN)
+    #include "YunClient.h"
+    YunClient client;
+#else
+  #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+    // Use WiFi  
+    #include <SPI.h>
+    #include <WiFi101.h>
+    char ssid[] = "<YOURNETWORK>";    //  your network SSID (name) 
+    char pass[] = "<YOURPASSWORD>";   // your network password   
+    int status = WL_IDLE_STATUS;
+    WiFiClient  client;
+  #elif defined(USE_ETHERNET_SHIELD)
+    // Use wired ethernet shield
+    #include <SPI.h>
+    #include <Ethernet.h>
+    byte mac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED};
+    EthernetClient client;
+  #endif
+#endif
+
+#include <ThingSpeak.h> // always include thingspeak header file after other header files and custom macros
+
+unsigned long testPublicChannelNumber = 209617;
+const char * testPublicChannelWriteAPIKey = "514SX5OBP2OFEPL2";
+
+unsigned long testPrivateChannelNumber = 209615;
+const char * testPrivateChannelReadAPIKey = "D3MJBCYVNFX4Z2A8";
+const char * testPrivateChannelWriteAPIKey = "KI8B7DJTWXLZ6EBV";
+
+#define WRITE_DELAY_FOR_THINGSPEAK 15000
+
+// Top of the heap, it grows when an allocation doesn't fit into a freed gap
+#ifdef __arm__
+  extern "C" char* sbrk(int incr);
+  char * heapTop() { return sbrk(0); }
+#else
+  extern char *__brkval;
+  extern char __heap_start;
+  char * heapTop() { return __brkval ? __brkval : &__heap_start; }
+#endif
+
+test(writeBufferReplaceCase)
+{
+  // Replacing a value moves the ones behind it, nothing gets lost
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(1, "first"));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(2, "second"));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(1, "1"));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setStatus("status"));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(2, ""));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(3, 3));
+
+  // Always wait 15 seconds to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeFields(testPrivateChannelNumber, testPrivateChannelWriteAPIKey));
+
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.readMultipleFields(testPrivateChannelNumber, testPrivateChannelReadAPIKey));
+  assertEqual("1", ThingSpeak.getFieldAsString(1));
+  assertEqual("", ThingSpeak.getFieldAsString(2));
+  assertEqual(3, ThingSpeak.getFieldAsInt(3));
+  assertEqual("status", ThingSpeak.getStatus());
+}
+
+test(writeBufferFullCase)
+{
+  char value[201];
+  memset(value, 'x', sizeof(value) - 1);
+  value[sizeof(value) - 1] = '\0';
+
+  // Each value takes its length plus a terminator, the first one that doesn't fit is refused
+  unsigned int fitting = TS_WRITE_BUFFER_SIZE / sizeof(value);
+  for(unsigned int field = 1; field <= 8; field++){
+    assertEqual(field <= fitting ? TS_OK_SUCCESS : TS_ERR_OUT_OF_RANGE, ThingSpeak.setField(field, value));
+  }
+
+  // writeFields starts over with an empty buffer
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeFields(testPrivateChannelNumber, testPrivateChannelWriteAPIKey));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(1, value));
+}
+
+test(writeBufferHeapCase)
+{
+  // Setting values over and over doesn't grow the heap (host/testAllocations counts the allocations themselves)
+  char * top = heapTop();
+  for(int i = 0; i < 1000; i++){
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(1, i));
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(2, (float)i / 3));
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(3, "constant"));
+  }
+  assertEqual((long)top, (long)heapTop());
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+  Serial.println("Starting test...");
+  #ifdef ARDUINO_AVR_YUN
+    Bridge.begin();
+  #else   
+    #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+      WiFi.begin(ssid, pass);
+    #else
+      Ethernet.begin(mac);
+    #endif
+  #endif
+  ThingSpeak.begin(client);
+}
+
+void loop()
+{
+  Test::run();
+}
@@ -267,6 +267,25 @@ test(writeFieldFloatCase)
   }
 #endif // Mega and MKR1000 only tests
 
+test(writeTemplateCase) 
+{
+  // Always wait to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+
+  // Test several fields of different types in one update
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.write<1, 2, 3>(testChannelNumber, testChannelWriteAPIKey, (float)3.14159, 42, "abc"));
+
+  // Test values out of range, nothing is sent
+  assertEqual(TS_ERR_OUT_OF_RANGE, ThingSpeak.write<1>(testChannelNumber, testChannelWriteAPIKey, (float)1e13));
+
+  // Test that values set before are left for writeFields()
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(FIELD1, 7));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.write<2>(testChannelNumber, testChannelWriteAPIKey, 8));
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeFields(testChannelNumber, testChannelWriteAPIKey));
+}
+
 void setup()
 {
   Serial.begin(9600);
@@ -10,9 +10,217 @@
 */
 
 #include "ThingSpeak.h"
-ThingSpeakClass ThingSpeak;
+
+// Headers that are the same for every request, put together at compile time
+static const char HTTPHeader[] = "Host: " THINGSPEAK_URL "\r\n"
+                                 "User-Agent: " TS_USER_AGENT "\r\n"
+                                 "Connection: keep-alive\r\n";
+
+// Collects a request so that it leaves in a single write. When a piece doesn't fit,
+// the collected part is written first, pieces larger than the whole buffer are written on their own.
+class RequestBuffer {
+  public:
+    RequestBuffer(Client * client, char * data, size_t size) : client(client), data(data), size(size) {}
+
+    bool append(const char * text, size_t length) {
+        if(this->length + length > this->size){
+            if(!flush()) return false;
+            if(length > this->size){
+                this->writes++;
+                return this->client->write((const uint8_t *)text, length) == length;
+            }
+        }
+        memcpy(this->data + this->length, text, length);
+        this->length += length;
+        return true;
+    }
+
+    bool append(const char * text) {
+        return append(text, strlen(text));
+    }
+
+    bool append(const String & text) {
+        return append(text.c_str(), text.length());
+    }
+
+    bool append(unsigned long value) {
+        char valueString[15];  // unsigned long range is 0 to 4294967295, so 11 bytes including terminator
+        ultoa(value, valueString, 10);
+        return append(valueString);
+    }
+
+    // Moves the text that directly follows the buffer in the same array up behind the collected part,
+    // so that it leaves in the same write
+    bool appendFollowing(size_t length) {
+        memmove(this->data + this->length, this->data + this->size, length);
+        this->length += length;
+        this->size += length;
+        return true;
+    }
+
+    bool flush() {
+        if(this->length == 0) return true;
+        this->writes++;
+        bool written = this->client->write((const uint8_t *)this->data, this->length) == this->length;
+        this->length = 0;
+        return written;
+    }
+
+    int getWrites() {
+        return this->writes;
+    }
+
+  private:
+    Client * client;
+    char * data;
+    size_t size;
+    size_t length = 0;
+    int writes = 0;
+};
+
+// Puts text together in a fixed buffer, nothing is appended once a piece doesn't fit
+class TextBuffer {
+  public:
+    TextBuffer(char * data, size_t size) : data(data), size(size) {}
+
+    bool append(const char * text, size_t length) {
+        if(this->length + length > this->size) return false;
+        memcpy(this->data + this->length, text, length);
+        this->length += length;
+        return true;
+    }
+
+    bool append(const char * text) {
+        return append(text, strlen(text));
+    }
+
+    bool append(unsigned long value) {
+        char valueString[15];  // unsigned long range is 0 to 4294967295, so 11 bytes including terminator
+        ultoa(value, valueString, 10);
+        return append(valueString);
+    }
+
+    size_t getLength() {
+        return this->length;
+    }
+
+  private:
+    char * data;
+    size_t size;
+    size_t length = 0;
+};
+
+// Writes value with up to 'decimals' (0-5) decimals and returns the end of the text.
+// The fraction is taken as a 32 bit fixed point number and rounded in integers, which
+// is exact for every float from 2^-8 up. Trailing zeros are left out, halves round away from zero.
+static char * formatFixed(float value, unsigned int decimals, char *valueString) {
+    static const uint32_t powers[] = {1, 10, 100, 1000, 10000, 100000};
+
+    if(isnan(value)){
+        strcpy(valueString, "nan");
+        return valueString + 3;
+    }
+    if(isinf(value)){
+        strcpy(valueString, value < 0 ? "-inf" : "inf");
+        return valueString + (value < 0 ? 4 : 3);
+    }
+
+    bool negative = value < 0;
+    if(negative) value = -value;
+    if(value >= 9.2e18f){
+        // Beyond 64 bit integers, only location values can get here
+#if defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_ARCH_SAM)
+        sprintf(valueString, "%s%.0f", negative ? "-" : "", value);
+#else
+        dtostrf(negative ? -value : value, 1, 0, valueString);
+#endif
+        return valueString + strlen(valueString);
+    }
+
+    uint64_t whole = (uint64_t)value;
+    uint64_t fraction = (uint64_t)((value - (float)whole) * 4294967296.0f);  // bits below 2^-32 are cut off
+    uint32_t scaled = (uint32_t)((fraction * powers[decimals] + 0x80000000u) >> 32);
+    if(scaled >= powers[decimals]){
+        // Rounded up into the next whole number
+        whole++;
+        scaled -= powers[decimals];
+    }
+    while(decimals > 0 && scaled % 10 == 0){
+        scaled /= 10;
+        decimals--;
+    }
+
+    // Digits are put together backwards, the fraction first
+    char digits[32];
+    char *p = digits;
+    for(unsigned int i = 0; i < decimals; i++){
+        *p++ = '0' + scaled % 10;
+        scaled /= 10;
+    }
+    if(decimals > 0) *p++ = '.';
+    uint32_t low = whole;
+    while(whole > 0xFFFFFFFFu){
+        // 64 bit division only for values above 4294967295
+        *p++ = '0' + whole % 10;
+        whole /= 10;
+        low = whole;
+    }
+    do{
+        *p++ = '0' + low % 10;
+        low /= 10;
+    } while(low > 0);
+
+    char *out = valueString;
+    if(negative && (p - digits > 1 || digits[0] != '0')) *out++ = '-';  // no "-0"
+    while(p > digits) *out++ = *--p;
+    *out = '\0';
+
+    return out;
+}
+
+// Location values are sent with 2 decimals, as String(float) used to give
+static const char * formatLocation(float value, char *valueString) {
+    formatFixed(value, 2, valueString);
+    return valueString;
+}
+
+#ifndef ARDUINO_AVR_UNO
+// Puts c as it goes into a JSON string into escaped, returns its length: 1, 2 for \" and \\ or 6 for a control character
+static size_t escapeJSON(char c, char *escaped) {
+    if(c == '"' || c == '\\'){
+        escaped[0] = '\\';
+        escaped[1] = c;
+        return 2;
+    }
+    if((unsigned char)c < 0x20){
+        char code[7];
+        sprintf(code, "\\u%04x", (unsigned int)c);
+        memcpy(escaped, code, 6);
+        return 6;
+    }
+    escaped[0] = c;
+    return 1;
+}
+#endif
+
+static bool appendHTTPHeader(RequestBuffer & request, const char *APIKey) {
+    if(!request.append(HTTPHeader, sizeof(HTTPHeader) - 1)) return false;
+    if(NULL != APIKey)
+    {
+        if(!request.append("X-THINGSPEAKAPIKEY: ")) return false;
+        if(!request.append(APIKey)) return false;
+        if(!request.append("\r\n")) return false;
+    }
+
+    return true;
+}
+
+ThingSpeakClass::RateLimitEntry ThingSpeakClass::rateLimit[TS_RATE_LIMIT_KEYS] = {};
 
 ThingSpeakClass::ThingSpeakClass() {
+    for(size_t iField = 0; iField < FIELDNUM_MAX; iField++){
+        this->fieldDecimals[iField] = TS_FLOAT_DECIMALS;
+    }
     resetWriteFields();
     this->lastReadStatus = TS_OK_SUCCESS;
 }
@@ -55,7 +263,7 @@ int ThingSpeakClass::writeField(unsigned long channelNumber, unsigned int field,
     Serial.print("ts::writeField (channelNumber: "); Serial.print(channelNumber); Serial.print(" writeAPIKey: "); Serial.print(writeAPIKey); Serial.print(" field: "); Serial.print(field); Serial.print(" value: "); Serial.print(value,5); Serial.println(")");
 #endif
     char valueString[20]; // range is -999999000000.00000 to 999999000000.00000, so 19 + 1 for the terminator
-    int status = convertFloatToChar(value, valueString);
+    int status = convertFloatToChar(value, valueString, getFieldDecimals(field));
     if(status != TS_OK_SUCCESS) return status;
 
     return writeField(channelNumber, field, valueString, writeAPIKey);
@@ -94,28 +302,44 @@ int ThingSpeakClass::setField(unsigned int field, long value) {
 
 int ThingSpeakClass::setField(unsigned int field, float value) {
     char valueString[20]; // range is -999999000000.00000 to 999999000000.00000, so 19 + 1 for the terminator
-    int status = convertFloatToChar(value, valueString);
+    int status = convertFloatToChar(value, valueString, getFieldDecimals(field));
     if(status != TS_OK_SUCCESS) return status;
 
     return setField(field, valueString);
 }
 
-int ThingSpeakClass::setField(unsigned int field, String value) {
+int ThingSpeakClass::setField(unsigned int field, const char *value) {
 #ifdef PRINT_DEBUG_MESSAGES
     Serial.print("ts::setField   (field: "); Serial.print(field); Serial.print(" value: \""); Serial.print(value); Serial.println("\")");
 #endif
     if(field < FIELDNUM_MIN || field > FIELDNUM_MAX) return TS_ERR_INVALID_FIELD_NUM;
-    // Max # bytes for ThingSpeak field is 255 (UTF-8)
-    if(value.length() > FIELDLENGTH_MAX) return TS_ERR_OUT_OF_RANGE;
-    this->nextWriteField[field - 1] = value;
+
+    return setWriteValue(field - 1, value, strlen(value));
+}
+
+int ThingSpeakClass::setField(unsigned int field, String value) {
+    return setField(field, value.c_str());
+}
+
+int ThingSpeakClass::setFieldPrecision(unsigned int field, unsigned int decimals) {
+    if(field < FIELDNUM_MIN || field > FIELDNUM_MAX) return TS_ERR_INVALID_FIELD_NUM;
+    if(decimals > TS_FLOAT_DECIMALS_MAX) return TS_ERR_OUT_OF_RANGE;
+    this->fieldDecimals[field - 1] = decimals;
 
     return TS_OK_SUCCESS;
 }
 
+unsigned int ThingSpeakClass::getFieldDecimals(unsigned int field) {
+    // An invalid field number is reported by setField() and writeField() afterwards
+    if(field < FIELDNUM_MIN || field > FIELDNUM_MAX) return TS_FLOAT_DECIMALS;
+    return this->fieldDecimals[field - 1];
+}
+
 int ThingSpeakClass::setLatitude(float latitude) {
 #ifdef PRINT_DEBUG_MESSAGES
     Serial.print("ts::setLatitude(latitude: "); Serial.print(latitude,3); Serial.println("\")");
 #endif
+    if(this->requestKind == REQUEST_WRITE) return TS_ERR_BUSY;
     this->nextWriteLatitude = latitude;
 
     return TS_OK_SUCCESS;
@@ -125,6 +349,7 @@ int ThingSpeakClass::setLongitude(float longitude) {
 #ifdef PRINT_DEBUG_MESSAGES
     Serial.print("ts::setLongitude(longitude: "); Serial.print(longitude,3); Serial.println("\")");
 #endif
+    if(this->requestKind == REQUEST_WRITE) return TS_ERR_BUSY;
     this->nextWriteLongitude = longitude;
 
     return TS_OK_SUCCESS;
@@ -134,59 +359,85 @@ int ThingSpeakClass::setElevation(float elevation) {
 #ifdef PRINT_DEBUG_MESSAGES
     Serial.print("ts::setElevation(elevation: "); Serial.print(elevation,3); Serial.println("\")");
 #endif
+    if(this->requestKind == REQUEST_WRITE) return TS_ERR_BUSY;
     this->nextWriteElevation = elevation;
 
     return TS_OK_SUCCESS;
 }
 
-int ThingSpeakClass::setStatus(String status) {
+int ThingSpeakClass::setStatus(const char *status) {
 #ifdef PRINT_DEBUG_MESSAGES
     Serial.print("ts::setStatus(status: "); Serial.print(status); Serial.println("\")");
 #endif
-    // Max # bytes for ThingSpeak field is 255 (UTF-8)
-    if(status.length() > FIELDLENGTH_MAX) return TS_ERR_OUT_OF_RANGE;
-    this->nextWriteStatus = status;
+    return setWriteValue(WRITE_STATUS, status, strlen(status));
+}
 
-    return TS_OK_SUCCESS;
+int ThingSpeakClass::setStatus(String status) {
+    return setStatus(status.c_str());
 }
 
-int ThingSpeakClass::setTwitterTweet(String twitter, String tweet) {
+int ThingSpeakClass::setTwitterTweet(const char *twitter, const char *tweet) {
 #ifdef PRINT_DEBUG_MESSAGES
     Serial.print("ts::setTwitterTweet(twitter: "); Serial.print(twitter); Serial.print(", tweet: "); Serial.print(tweet); Serial.println("\")");
 #endif
-    // Max # bytes for ThingSpeak field is 255 (UTF-8)
-    if((twitter.length() > FIELDLENGTH_MAX) || (tweet.length() > FIELDLENGTH_MAX)) return TS_ERR_OUT_OF_RANGE;
+    size_t twitterLength = strlen(twitter);
+    size_t tweetLength = strlen(tweet);
 
-    this->nextWriteTwitter = twitter;
-    this->nextWriteTweet = tweet;
+    // Max # bytes for ThingSpeak field is 255 (UTF-8)
+    if((twitterLength > FIELDLENGTH_MAX) || (tweetLength > FIELDLENGTH_MAX)) return TS_ERR_OUT_OF_RANGE;
+
+    // Both values have to fit, otherwise the old ones stay
+    size_t used = this->writeUsed;
+    if(this->writeLength[WRITE_TWITTER] > 0) used -= this->writeLength[WRITE_TWITTER] + 1;
+    if(this->writeLength[WRITE_TWEET] > 0) used -= this->writeLength[WRITE_TWEET] + 1;
+    if(twitterLength > 0) used += twitterLength + 1;
+    if(tweetLength > 0) used += tweetLength + 1;
+    if(used > TS_WRITE_BUFFER_SIZE) return TS_ERR_OUT_OF_RANGE;
+
+    setWriteValue(WRITE_TWITTER, twitter, twitterLength);
+    return setWriteValue(WRITE_TWEET, tweet, tweetLength);
+}
 
-    return TS_OK_SUCCESS;
+int ThingSpeakClass::setTwitterTweet(String twitter, String tweet) {
+    return setTwitterTweet(twitter.c_str(), tweet.c_str());
 }
 
-int ThingSpeakClass::setCreatedAt(String createdAt) {
+int ThingSpeakClass::setCreatedAt(const char *createdAt) {
 #ifdef PRINT_DEBUG_MESSAGES
     Serial.print("ts::setCreatedAt(createdAt: "); Serial.print(createdAt); Serial.println("\")");
 #endif
 
     // the ISO 8601 format is too complicated to check for valid timestamps here
     // we'll need to reply on the api to tell us if there is a problem
-    // Max # bytes for ThingSpeak field is 255 (UTF-8)
-    if(createdAt.length() > FIELDLENGTH_MAX) return TS_ERR_OUT_OF_RANGE;
-    this->nextWriteCreatedAt = createdAt;
+    return setWriteValue(WRITE_CREATED_AT, createdAt, strlen(createdAt));
+}
 
-    return TS_OK_SUCCESS;
+int ThingSpeakClass::setCreatedAt(String createdAt) {
+    return setCreatedAt(createdAt.c_str());
 }
 
 int ThingSpeakClass::writeFields(unsigned long channelNumber, const char *writeAPIKey) {
-    if(!connectThingSpeak()){
-        // Failed to connect to ThingSpeak
-        return TS_ERR_CONNECT_FAILED;
+    int status = startWrite(channelNumber, writeAPIKey, NULL, false);
+    if(status != TS_OK_SUCCESS) return status;
+
+    return waitForRequest();
+}
+
+int ThingSpeakClass::beginWrite(unsigned long channelNumber, const char *writeAPIKey, ThingSpeakCallback callback) {
+    return startWrite(channelNumber, writeAPIKey, callback, true);
+}
+
+int ThingSpeakClass::startWrite(unsigned long channelNumber, const char *writeAPIKey, ThingSpeakCallback callback, bool hold) {
+    if(hold && isHeld(REQUEST_WRITE, writeAPIKey)){
+        // Still held back by the rate limit, the values set meanwhile go along
+        this->heldCallback = callback;
+        return TS_OK_SUCCESS;
     }
 
-    // Get the content length of the payload
-    int contentLen = getWriteFieldsContentLength();
+    // The values set meanwhile belong to the write in progress or the one held back
+    if(this->requestKind != REQUEST_NONE || this->heldKind == REQUEST_WRITE) return TS_ERR_BUSY;
 
-    if(contentLen == 0){
+    if(!hasWriteValues()){
         // setField was not called before writeFields
         return TS_ERR_SETFIELD_NOT_CALLED;
     }
@@ -195,130 +446,374 @@ int ThingSpeakClass::writeFields(unsigned long channelNumber, const char *writeA
     Serial.print("ts::writeFields   (channelNumber: "); Serial.print(channelNumber); Serial.print(" writeAPIKey: "); Serial.println(writeAPIKey);
 #endif
 
-    // Post data to thingspeak
-    if(!this->client->print("POST /update HTTP/1.1\r\n")) return abortWriteRaw();
-    if(!writeHTTPHeader(writeAPIKey)) return abortWriteRaw();
-    if(!this->client->print("Content-Type: application/x-www-form-urlencoded\r\n")) return abortWriteRaw();
-    if(!this->client->print("Content-Length: ")) return abortWriteRaw();
-    if(!this->client->print(contentLen)) return abortWriteRaw();
-    if(!this->client->print("\r\n\r\n")) return abortWriteRaw();
+    return beginRequest(REQUEST_WRITE, channelNumber, 0, writeAPIKey, callback, hold);
+}
 
-    bool fFirstItem = true;
-    for(size_t iField = 0; iField < FIELDNUM_MAX; iField++){
-        if(this->nextWriteField[iField].length() > 0){
-            if(!fFirstItem){
-                if(!this->client->print("&")) return abortWriteRaw();
-            }
-            if(!this->client->print("field")) return abortWriteRaw();
-            if(!this->client->print(iField + 1)) return abortWriteRaw();
-            if(!this->client->print("=")) return abortWriteRaw();
-            if(!this->client->print(this->nextWriteField[iField])) return abortWriteRaw();
-            fFirstItem = false;
-        }
+int ThingSpeakClass::postFields(const char *writeAPIKey) {
+    // The body is put together once, its length is the Content-Length. It moves to the end of
+    // the buffer, the headers are collected in front of it and it is pulled up behind them.
+    char buffer[TS_WRITE_BODY_SIZE];
+    int contentLen = serializeFields(buffer, sizeof(buffer));
+    if(contentLen < 0) return contentLen;
+    size_t headerSize = sizeof(buffer) - contentLen;
+    memmove(buffer + headerSize, buffer, contentLen);
+
+    if(!connectThingSpeak()){
+        // Failed to connect to ThingSpeak
+        return TS_ERR_CONNECT_FAILED;
     }
 
-    if(!isnan(this->nextWriteLatitude)){
-        if(!fFirstItem){
-            if(!this->client->print("&")) return abortWriteRaw();
+    // Post data to thingspeak, collected into one write
+    RequestBuffer request(this->client, buffer, headerSize);
+
+    bool ok = request.append("POST /update HTTP/1.1\r\n")
+           && appendHTTPHeader(request, writeAPIKey)
+           && request.append("Content-Type: application/x-www-form-urlencoded\r\nContent-Length: ")
+           && request.append((unsigned long)contentLen)
+           && request.append("\r\n\r\n")
+           && request.appendFollowing(contentLen)
+           && request.flush();
+
+#ifdef PRINT_DEBUG_MESSAGES
+    Serial.print("               Request sent in "); Serial.print(request.getWrites()); Serial.println(" write(s)");
+#endif
+
+    if(!ok) return abortWriteRaw();
+
+    return TS_OK_SUCCESS;
+}
+
+int ThingSpeakClass::serializeFields(char *body, size_t size) {
+    TextBuffer text(body, size);
+
+    bool ok = true;
+    const char *separator = "";
+    for(size_t iField = 0; ok && iField < FIELDNUM_MAX; iField++){
+        if(this->writeLength[iField] > 0){
+            ok = text.append(separator)
+              && text.append("field")
+              && text.append((unsigned long)(iField + 1))
+              && text.append("=")
+              && text.append(getWriteValue(iField), this->writeLength[iField]);
+            separator = "&";
         }
-        if(!this->client->print("lat=")) return abortWriteRaw();
-        if(!this->client->print(this->nextWriteLatitude)) return abortWriteRaw();
-        fFirstItem = false;
     }
 
-    if(!isnan(this->nextWriteLongitude)){
-        if(!fFirstItem){
-            if(!this->client->print("&")) return abortWriteRaw();
-        }
-        if(!this->client->print("long=")) return abortWriteRaw();
-        if(!this->client->print(this->nextWriteLongitude)) return abortWriteRaw();
-        fFirstItem = false;
+    char locationString[48];  // the largest float with 2 decimals has 39 digits before the point
+    if(ok && !isnan(this->nextWriteLatitude)){
+        ok = text.append(separator) && text.append("lat=") && text.append(formatLocation(this->nextWriteLatitude, locationString));
+        separator = "&";
     }
 
-    if(!isnan(this->nextWriteElevation)){
-        if(!fFirstItem){
-            if(!this->client->print("&")) return abortWriteRaw();
-        }
-        if(!this->client->print("elevation=")) return abortWriteRaw();
-        if(!this->client->print(this->nextWriteElevation)) return abortWriteRaw();
-        fFirstItem = false;
+    if(ok && !isnan(this->nextWriteLongitude)){
+        ok = text.append(separator) && text.append("long=") && text.append(formatLocation(this->nextWriteLongitude, locationString));
+        separator = "&";
     }
 
-    if(this->nextWriteStatus.length() > 0){
-        if(!fFirstItem){
-            if(!this->client->print("&")) return abortWriteRaw();
-        }
-        if(!this->client->print("status=")) return abortWriteRaw();
-        if(!this->client->print(this->nextWriteStatus)) return abortWriteRaw();
-        fFirstItem = false;
+    if(ok && !isnan(this->nextWriteElevation)){
+        ok = text.append(separator) && text.append("elevation=") && text.append(formatLocation(this->nextWriteElevation, locationString));
+        separator = "&";
     }
 
-    if(this->nextWriteTwitter.length() > 0){
-        if(!fFirstItem){
-            if(!this->client->print("&")) return abortWriteRaw();
+    static const char * const textKeys[] = {"status=", "twitter=", "tweet=", "created_at="};
+    for(size_t slot = WRITE_STATUS; ok && slot < WRITE_SLOTS; slot++){
+        if(this->writeLength[slot] > 0){
+            ok = text.append(separator)
+              && text.append(textKeys[slot - WRITE_STATUS])
+              && text.append(getWriteValue(slot), this->writeLength[slot]);
+            separator = "&";
         }
-        if(!this->client->print("twitter=")) return abortWriteRaw();
-        if(!this->client->print(this->nextWriteTwitter)) return abortWriteRaw();
-        fFirstItem = false;
     }
 
-    if(this->nextWriteTweet.length() > 0){
-        if(!fFirstItem){
-            if(!this->client->print("&")) return abortWriteRaw();
-        }
-        if(!this->client->print("tweet=")) return abortWriteRaw();
-        if(!this->client->print(this->nextWriteTweet)) return abortWriteRaw();
-        fFirstItem = false;
+    ok = ok && text.append("&headers=false");
+
+    // Only location values far beyond the earth can overflow TS_WRITE_BODY_SIZE
+    if(!ok) return TS_ERR_OUT_OF_RANGE;
+
+    return text.getLength();
+}
+
+int ThingSpeakClass::writeRaw(unsigned long channelNumber, String postMessage, const char *writeAPIKey) {
+#ifdef PRINT_DEBUG_MESSAGES
+    Serial.print("ts::writeRaw   (channelNumber: "); Serial.print(channelNumber); Serial.print(" writeAPIKey: "); Serial.println(writeAPIKey);
+#endif
+
+    if(this->requestKind != REQUEST_NONE) return TS_ERR_BUSY;
+
+    postMessage.concat("&headers=false");
+
+#ifdef PRINT_DEBUG_MESSAGES
+    Serial.print("               POST \"");Serial.print(postMessage);Serial.println("\"");
+#endif
+
+    int status = writeBody(channelNumber, postMessage.c_str(), postMessage.length(), writeAPIKey);
+
+    // The values of a write held back by beginWrite() are still needed
+    if(this->heldKind != REQUEST_WRITE) resetWriteFields();
+
+    return status;
+}
+
+int ThingSpeakClass::writeBody(unsigned long channelNumber, const char *body, size_t length, const char *writeAPIKey) {
+#ifdef PRINT_DEBUG_MESSAGES
+    Serial.print("ts::writeBody  (channelNumber: "); Serial.print(channelNumber); Serial.print(" length: "); Serial.print(length); Serial.println(")");
+#endif
+
+    // ThingSpeak would answer with entry ID 0, no need to pay for the request
+    uint32_t keyHash = hashKey(writeAPIKey);
+    if(getRateLimitWait(keyHash) > 0) return TS_ERR_NOT_INSERTED;
+
+    int status = postRaw(body, length, writeAPIKey);
+    if(status == TS_ERR_CONNECTION_CLOSED){
+        // The server closed the kept-alive connection in the meantime, send once more on a fresh one
+        status = postRaw(body, length, writeAPIKey);
+    }
+
+    if(status == TS_OK_SUCCESS) setRateLimitWrite(keyHash);
+
+    return status;
+}
+
+int ThingSpeakClass::appendValue(char *&out, unsigned int /*field*/, int value) {
+    itoa(value, out, 10);
+    out += strlen(out);
+    return TS_OK_SUCCESS;
+}
+
+int ThingSpeakClass::appendValue(char *&out, unsigned int /*field*/, long value) {
+    ltoa(value, out, 10);
+    out += strlen(out);
+    return TS_OK_SUCCESS;
+}
+
+int ThingSpeakClass::appendValue(char *&out, unsigned int field, float value) {
+    int status = convertFloatToChar(value, out, getFieldDecimals(field));
+    if(status != TS_OK_SUCCESS) return status;
+    out += strlen(out);
+    return TS_OK_SUCCESS;
+}
+
+int ThingSpeakClass::appendValue(char *&out, unsigned int field, double value) {
+    return appendValue(out, field, (float)value);
+}
+
+int ThingSpeakClass::appendValue(char *&out, unsigned int /*field*/, const char *value) {
+    // Max # bytes for ThingSpeak field is 255 (UTF-8)
+    size_t length = strlen(value);
+    if(length > FIELDLENGTH_MAX) return TS_ERR_OUT_OF_RANGE;
+    memcpy(out, value, length);
+    out += length;
+    return TS_OK_SUCCESS;
+}
+
+int ThingSpeakClass::appendValue(char *&out, unsigned int field, const String &value) {
+    return appendValue(out, field, value.c_str());
+}
+
+int ThingSpeakClass::postRaw(const char *postMessage, size_t length, const char *writeAPIKey) {
+    if(!connectThingSpeak())
+    {
+        // Failed to connect to ThingSpeak
+        return TS_ERR_CONNECT_FAILED;
+    }
+
+    // Post data to thingspeak, collected into one write
+    char buffer[TS_REQUEST_BUFFER_SIZE];
+    RequestBuffer request(this->client, buffer, sizeof(buffer));
+
+    bool ok = request.append("POST /update HTTP/1.1\r\n")
+           && appendHTTPHeader(request, writeAPIKey)
+           && request.append("Content-Type: application/x-www-form-urlencoded\r\nContent-Length: ")
+           && request.append((unsigned long)length)
+           && request.append("\r\n\r\n")
+           && request.append(postMessage, length)
+           && request.flush();
+
+#ifdef PRINT_DEBUG_MESSAGES
+    Serial.print("               Request sent in "); Serial.print(request.getWrites()); Serial.println(" write(s)");
+#endif
+
+    if(!ok) return abortWriteRaw();
+
+    return finishWrite();
+}
+
+#ifndef ARDUINO_AVR_UNO
+
+int ThingSpeakClass::addBulkEntry(String createdAt) {
+    return appendBulkEntry("created_at", createdAt.c_str(), true);
+}
+
+int ThingSpeakClass::addBulkEntry(unsigned long deltaT) {
+    char deltaString[15];  // unsigned long range is 0 to 4294967295, so 11 bytes including terminator
+    ultoa(deltaT, deltaString, 10);
+    return appendBulkEntry("delta_t", deltaString, false);
+}
+
+int ThingSpeakClass::appendBulkEntry(const char *timeKey, const char *timeValue, bool quoteTime) {
+    // The buffer is cleared when the bulk update in progress succeeds, one held back by the rate limit takes new entries along
+    if(this->requestKind == REQUEST_BULK) return TS_ERR_BUSY;
+
+    if(!hasWriteValues()){
+        // setField was not called before addBulkEntry
+        return TS_ERR_SETFIELD_NOT_CALLED;
     }
 
-    if(this->nextWriteCreatedAt.length() > 0){
-        if(!fFirstItem){
-            if(!this->client->print("&")) return abortWriteRaw();
+#ifdef PRINT_DEBUG_MESSAGES
+    Serial.print("ts::addBulkEntry(");Serial.print(timeKey);Serial.print(": ");Serial.print(timeValue);Serial.println(")");
+#endif
+
+    size_t entryStart = this->bulkLength;
+
+    bool fits = appendBulk(this->bulkCount > 0 ? ",{\"" : "{\"")
+             && appendBulk(timeKey)
+             && appendBulk(quoteTime ? "\":\"" : "\":")
+             && appendBulk(timeValue, true)
+             && appendBulk(quoteTime ? "\"" : "");
+
+    for(size_t iField = 0; fits && iField < FIELDNUM_MAX; iField++){
+        if(this->writeLength[iField] > 0){
+            char key[12];  // ,"fieldX":"
+            sprintf(key, ",\"field%u\":\"", (unsigned int)(iField + 1));
+            fits = appendBulk(key)
+                && appendBulk(getWriteValue(iField), true)
+                && appendBulk("\"");
         }
-        if(!this->client->print("created_at=")) return abortWriteRaw();
-        if(!this->client->print(this->nextWriteCreatedAt)) return abortWriteRaw();
-        fFirstItem = false;
     }
 
-    if(!this->client->print("&headers=false")) return abortWriteRaw();
+    char locationString[48];  // the largest float with 2 decimals has 39 digits before the point
+    if(fits && !isnan(this->nextWriteLatitude)){
+        fits = appendBulk(",\"latitude\":") && appendBulk(formatLocation(this->nextWriteLatitude, locationString));
+    }
+    if(fits && !isnan(this->nextWriteLongitude)){
+        fits = appendBulk(",\"longitude\":") && appendBulk(formatLocation(this->nextWriteLongitude, locationString));
+    }
+    if(fits && !isnan(this->nextWriteElevation)){
+        fits = appendBulk(",\"elevation\":") && appendBulk(formatLocation(this->nextWriteElevation, locationString));
+    }
+    if(fits && this->writeLength[WRITE_STATUS] > 0){
+        fits = appendBulk(",\"status\":\"")
+            && appendBulk(getWriteValue(WRITE_STATUS), true)
+            && appendBulk("\"");
+    }
 
+    fits = fits && appendBulk("}");
+
+    if(!fits){
+        // Drop the partial entry, the values stay set for another try after writeBulk()
+        this->bulkLength = entryStart;
+        return TS_ERR_BULK_FULL;
+    }
+
+    this->bulkCount++;
     resetWriteFields();
 
-    return finishWrite();
+    return TS_OK_SUCCESS;
 }
 
-int ThingSpeakClass::writeRaw(unsigned long channelNumber, String postMessage, const char *writeAPIKey) {
+bool ThingSpeakClass::appendBulk(const char *text, bool escape) {
+    for(; *text != '\0'; text++){
+        char escaped[6] = {*text};
+        size_t length = escape ? escapeJSON(*text, escaped) : 1;
+        if(this->bulkLength + length > TS_BULK_BUFFER_SIZE){
+            return false;
+        }
+        memcpy(this->bulkBuffer + this->bulkLength, escaped, length);
+        this->bulkLength += length;
+    }
+
+    return true;
+}
+
+int ThingSpeakClass::writeBulk(unsigned long channelNumber, const char *writeAPIKey) {
+    int status = startWriteBulk(channelNumber, writeAPIKey, NULL, false);
+    if(status != TS_OK_SUCCESS) return status;
+
+    return waitForRequest();
+}
+
+int ThingSpeakClass::beginWriteBulk(unsigned long channelNumber, const char *writeAPIKey, ThingSpeakCallback callback) {
+    return startWriteBulk(channelNumber, writeAPIKey, callback, true);
+}
+
+int ThingSpeakClass::startWriteBulk(unsigned long channelNumber, const char *writeAPIKey, ThingSpeakCallback callback, bool hold) {
+    // The bulk update carries its key in the body, there is no default one to fall back to
+    if(writeAPIKey == NULL || writeAPIKey[0] == '\0') return TS_ERR_BADAPIKEY;
+
+    if(hold && isHeld(REQUEST_BULK, writeAPIKey)){
+        // Still held back by the rate limit, the entries added meanwhile go along
+        this->heldCallback = callback;
+        return TS_OK_SUCCESS;
+    }
+
+    // The entries belong to the bulk update in progress or the one held back
+    if(this->requestKind != REQUEST_NONE || this->heldKind == REQUEST_BULK) return TS_ERR_BUSY;
+
+    if(this->bulkCount == 0){
+        // addBulkEntry was not called before writeBulk
+        return TS_ERR_SETFIELD_NOT_CALLED;
+    }
+
 #ifdef PRINT_DEBUG_MESSAGES
-    Serial.print("ts::writeRaw   (channelNumber: "); Serial.print(channelNumber); Serial.print(" writeAPIKey: "); Serial.println(writeAPIKey);
+    Serial.print("ts::writeBulk   (channelNumber: "); Serial.print(channelNumber); Serial.print(" entries: "); Serial.print(this->bulkCount); Serial.print(" bytes: "); Serial.print(this->bulkLength); Serial.println(")");
 #endif
 
+    return beginRequest(REQUEST_BULK, channelNumber, 0, writeAPIKey, callback, hold);
+}
+int ThingSpeakClass::postBulk(unsigned long channelNumber, const char *writeAPIKey) {
     if(!connectThingSpeak())
     {
         // Failed to connect to ThingSpeak
         return TS_ERR_CONNECT_FAILED;
     }
 
-    postMessage.concat("&headers=false");
+    // The key goes into a JSON string like the values of the entries
+    char key[TS_API_KEY_LENGTH * 6];  // every character as \u00XX at worst
+    size_t keyLength = 0;
+    for(const char *c = writeAPIKey; *c != '\0'; c++){
+        keyLength += escapeJSON(*c, key + keyLength);
+    }
+
+    // {"write_api_key":"<key>","updates":[<entries>]}
+    size_t contentLen = 18 + keyLength + 13 + this->bulkLength + 2;
+
+    // Entries that don't fit behind the header are streamed straight from the bulk buffer
+    char buffer[TS_REQUEST_BUFFER_SIZE];
+    RequestBuffer request(this->client, buffer, sizeof(buffer));
+
+    bool ok = request.append("POST /channels/")
+           && request.append(channelNumber)
+           && request.append("/bulk_update.json HTTP/1.1\r\n")
+           && appendHTTPHeader(request, NULL)
+           && request.append("Content-Type: application/json\r\nContent-Length: ")
+           && request.append((unsigned long)contentLen)
+           && request.append("\r\n\r\n{\"write_api_key\":\"")
+           && request.append(key, keyLength)
+           && request.append("\",\"updates\":[")
+           && request.append(this->bulkBuffer, this->bulkLength)
+           && request.append("]}")
+           && request.flush();
 
 #ifdef PRINT_DEBUG_MESSAGES
-    Serial.print("               POST \"");Serial.print(postMessage);Serial.println("\"");
+    Serial.print("               Request sent in "); Serial.print(request.getWrites()); Serial.println(" write(s)");
 #endif
 
+    if(!ok) return abortWriteRaw();
 
-    // Post data to thingspeak
-    if(!this->client->print("POST /update HTTP/1.1\r\n")) return abortWriteRaw();
-    if(!writeHTTPHeader(writeAPIKey)) return abortWriteRaw();
-    if(!this->client->print("Content-Type: application/x-www-form-urlencoded\r\n")) return abortWriteRaw();
-    if(!this->client->print("Content-Length: ")) return abortWriteRaw();
-    if(!this->client->print(postMessage.length())) return abortWriteRaw();
-    if(!this->client->print("\r\n\r\n")) return abortWriteRaw();
-    if(!this->client->print(postMessage)) return abortWriteRaw();
+    return TS_OK_SUCCESS;
+}
 
-    resetWriteFields();
+int ThingSpeakClass::getBulkCount() {
+    return this->bulkCount;
+}
 
-    return finishWrite();
+void ThingSpeakClass::clearBulk() {
+    this->bulkLength = 0;
+    this->bulkCount = 0;
 }
 
+#endif
+
 String ThingSpeakClass::readStringField(unsigned long channelNumber, unsigned int field, const char *readAPIKey) {
     if(field < FIELDNUM_MIN || field > FIELDNUM_MAX)
     {
@@ -398,6 +893,11 @@ String ThingSpeakClass::readCreatedAt(unsigned long channelNumber) {
 }
 
 String ThingSpeakClass::readRaw(unsigned long channelNumber, String suffixURL, const char *readAPIKey) {
+    if(this->requestKind != REQUEST_NONE){
+        this->lastReadStatus = TS_ERR_BUSY;
+        return String("");
+    }
+
 #ifdef PRINT_DEBUG_MESSAGES
     Serial.print("ts::readRaw   (channelNumber: "); Serial.print(channelNumber);
                 if(NULL != readAPIKey)
@@ -407,12 +907,6 @@ String ThingSpeakClass::readRaw(unsigned long channelNumber, String suffixURL, c
                 Serial.print(" suffixURL: \""); Serial.print(suffixURL); Serial.println("\")");
 #endif
 
-    if(!connectThingSpeak())
-    {
-        this->lastReadStatus = TS_ERR_CONNECT_FAILED;
-        return String("");
-    }
-
     String readURL = String("/channels/");
     readURL.concat(channelNumber);
     readURL.concat(suffixURL);
@@ -421,40 +915,331 @@ String ThingSpeakClass::readRaw(unsigned long channelNumber, String suffixURL, c
     Serial.print("               GET \"");Serial.print(readURL);Serial.println("\"");
 #endif
 
-    // Get data from thingspeak
-    if(!this->client->print("GET ")) return abortReadRaw();
-    if(!this->client->print(readURL)) return abortReadRaw();
-    if(!this->client->print(" HTTP/1.1\r\n")) return abortReadRaw();
-    if(!writeHTTPHeader(readAPIKey)) return abortReadRaw();
-    if(!this->client->print("\r\n")) return abortReadRaw();
+    String content = getRaw(readURL, readAPIKey);
+    if(this->lastReadStatus == TS_ERR_CONNECTION_CLOSED){
+        // The server closed the kept-alive connection in the meantime, ask once more on a fresh one
+        content = getRaw(readURL, readAPIKey);
+    }
 
-    String content = String();
-    int status = getHTTPResponse(content);
+    return content;
+}
 
-    this->lastReadStatus = status;
+String ThingSpeakClass::getRaw(const String &readURL, const char *readAPIKey) {
+    int contentLength = 0;
+    if(!requestRaw(readURL.c_str(), readAPIKey, contentLength)){
+        return String("");
+    }
+
+    String content = String();
+    content.reserve(contentLength);
+    for(int i = 0; i < contentLength; i++){
+        content.concat((char)this->client->read());
+    }
 
     emptyStream();
 
 #ifdef PRINT_DEBUG_MESSAGES
-    if(status == TS_OK_SUCCESS)
-                {
-                    Serial.print("Read: \""); Serial.print(content); Serial.println("\"");
-                }
+    Serial.print("Read: \""); Serial.print(content); Serial.println("\"");
 #endif
 
-    this->client->stop();
+    endRequest();
+
+    return content;
+}
+
+bool ThingSpeakClass::requestRaw(const char *readURL, const char *readAPIKey, int &contentLength) {
+    if(postRead(readURL, readAPIKey) != TS_OK_SUCCESS){
+        return false;
+    }
+
+    int status = getHTTPResponse(contentLength);
+
+    this->lastReadStatus = status;
+
+    if(status != TS_OK_SUCCESS)
+    {
+        emptyStream();
+        this->client->stop();
 #ifdef PRINT_DEBUG_MESSAGES
-    Serial.println("disconnected.");
+        Serial.println("disconnected.");
 #endif
+        return false;
+    }
 
-    if(status != TS_OK_SUCCESS)
+    // The body is waiting in the client
+    return true;
+}
+
+int ThingSpeakClass::postRead(const char *readURL, const char *readAPIKey) {
+    if(!connectThingSpeak())
     {
-        return String("");
+        this->lastReadStatus = TS_ERR_CONNECT_FAILED;
+        return TS_ERR_CONNECT_FAILED;
     }
 
-    return content;
+    // Get data from thingspeak, collected into one write
+    char buffer[TS_REQUEST_BUFFER_SIZE];
+    RequestBuffer request(this->client, buffer, sizeof(buffer));
+
+    bool ok = request.append("GET ")
+           && request.append(readURL)
+           && request.append(" HTTP/1.1\r\n")
+           && appendHTTPHeader(request, readAPIKey)
+           && request.append("\r\n")
+           && request.flush();
+
+    if(!ok){
+        abortReadRaw();
+        return this->lastReadStatus;
+    }
+
+    return TS_OK_SUCCESS;
+}
+
+int ThingSpeakClass::beginRead(unsigned long channelNumber, unsigned int field, const char *readAPIKey, ThingSpeakCallback callback) {
+    if(this->requestKind != REQUEST_NONE) return TS_ERR_BUSY;
+
+    if(field < FIELDNUM_MIN || field > FIELDNUM_MAX) return TS_ERR_INVALID_FIELD_NUM;
+
+#ifdef PRINT_DEBUG_MESSAGES
+    Serial.print("ts::beginRead (channelNumber: "); Serial.print(channelNumber); Serial.print(" field: "); Serial.print(field); Serial.println(")");
+#endif
+
+    return beginRequest(REQUEST_READ, channelNumber, field, readAPIKey, callback, false);
+}
+
+bool ThingSpeakClass::poll() {
+    if(this->requestKind != REQUEST_NONE && pollRequest()) return true;
+
+    // A write held back by the rate limit goes out once the window is over and nothing else is in progress
+    if(this->requestKind == REQUEST_NONE && this->heldKind != REQUEST_NONE) sendHeld();
+
+    return this->requestKind != REQUEST_NONE || this->heldKind != REQUEST_NONE;
+}
+
+bool ThingSpeakClass::pollRequest() {
+    int status = pollResponse();
+    if(status == RESPONSE_PENDING) return true;
+
+    if(status == TS_ERR_CONNECTION_CLOSED && !this->requestRetried){
+        // The server closed the kept-alive connection in the meantime, send once more on a fresh one
+        this->client->stop();
+        this->requestRetried = true;
+        status = sendRequest();
+        if(status == TS_OK_SUCCESS) return true;
+    }
+
+    completeRequest(status);
+
+    // unless the callback started the next one
+    return this->requestKind != REQUEST_NONE;
+}
+
+int ThingSpeakClass::beginRequest(uint8_t kind, unsigned long channelNumber, unsigned int field, const char *APIKey, ThingSpeakCallback callback, bool hold) {
+    // The key is copied, the caller's string doesn't have to outlive this call
+    if(APIKey != NULL && strlen(APIKey) > TS_API_KEY_LENGTH) return TS_ERR_BADAPIKEY;
+    uint32_t keyHash = hashKey(APIKey);
+
+    unsigned long wait = kind == REQUEST_READ ? 0 : getRateLimitWait(keyHash);
+    if(wait > 0 && !hold){
+        // ThingSpeak would answer with entry ID 0 and drop the values, no need to pay for that request
+        if(kind == REQUEST_WRITE) resetWriteFields();
+        return TS_ERR_NOT_INSERTED;
+    }
+    if(wait > 0){
+        // beginWrite() and beginWriteBulk() hold the write back until poll() finds the window over
+        if(this->heldKind != REQUEST_NONE) return TS_ERR_BUSY;
+#ifdef PRINT_DEBUG_MESSAGES
+        Serial.print("               Held back "); Serial.print(wait); Serial.println(" ms by the rate limit");
+#endif
+        this->heldKind = kind;
+        this->heldChannel = channelNumber;
+        copyKey(this->heldKey, APIKey);
+        this->heldKeyHash = keyHash;
+        this->heldCallback = callback;
+        return TS_OK_SUCCESS;
+    }
+
+    this->requestKind = kind;
+    this->requestChannel = channelNumber;
+    this->requestField = field;
+    copyKey(this->requestKey, APIKey);
+    this->requestKeyHash = keyHash;
+    this->requestCallback = callback;
+
+    int status = dispatchRequest();
+    if(status != TS_OK_SUCCESS){
+        // Nothing went out, the caller gets the status right away instead of the callback
+        this->requestCallback = NULL;
+        return completeRequest(status);
+    }
+
+    return TS_OK_SUCCESS;
+}
+
+void ThingSpeakClass::sendHeld() {
+    // Another write with this key may have been accepted meanwhile, e.g. by writeField()
+    if(getRateLimitWait(this->heldKeyHash) > 0) return;
+
+    this->requestKind = this->heldKind;
+    this->requestChannel = this->heldChannel;
+    this->requestField = 0;
+    memcpy(this->requestKey, this->heldKey, sizeof(this->requestKey));
+    this->requestKeyHash = this->heldKeyHash;
+    this->requestCallback = this->heldCallback;
+    this->heldKind = REQUEST_NONE;
+
+    // The caller of beginWrite() is long gone, a failure goes to the callback
+    int status = dispatchRequest();
+    if(status != TS_OK_SUCCESS) completeRequest(status);
+}
+
+int ThingSpeakClass::dispatchRequest() {
+    this->requestRetried = false;
+    int status = sendRequest();
+    if(status == TS_ERR_CONNECTION_CLOSED){
+        // The server closed the kept-alive connection in the meantime, send once more on a fresh one
+        this->requestRetried = true;
+        status = sendRequest();
+    }
+
+    return status;
+}
+
+bool ThingSpeakClass::isHeld(uint8_t kind, const char *APIKey) {
+    return this->heldKind == kind && this->heldKeyHash == hashKey(APIKey) && strcmp(this->heldKey, APIKey != NULL ? APIKey : "") == 0;
+}
+
+void ThingSpeakClass::copyKey(char *to, const char *APIKey) {
+    // NULL (no key) is kept as an empty string
+    strncpy(to, APIKey != NULL ? APIKey : "", TS_API_KEY_LENGTH);
+    to[TS_API_KEY_LENGTH] = '\0';
+}
+
+unsigned long ThingSpeakClass::getRateLimitWait(uint32_t key) {
+    for(size_t i = 0; i < TS_RATE_LIMIT_KEYS; i++){
+        unsigned long since = millis() - rateLimit[i].acceptedAt;
+        if(rateLimit[i].key == key && since < TS_RATE_LIMIT_MS){
+            return TS_RATE_LIMIT_MS - since;
+        }
+    }
+
+    return 0;
+}
+
+void ThingSpeakClass::setRateLimitWrite(uint32_t key) {
+    // The entry of this key, otherwise an unused one or the one written longest ago
+    size_t slot = 0;
+    unsigned long oldest = 0;
+    for(size_t i = 0; i < TS_RATE_LIMIT_KEYS; i++){
+        if(rateLimit[i].key == key){
+            slot = i;
+            break;
+        }
+        unsigned long age = rateLimit[i].key == 0 ? (unsigned long)-1 : millis() - rateLimit[i].acceptedAt;
+        if(age >= oldest){
+            oldest = age;
+            slot = i;
+        }
+    }
+
+    rateLimit[slot].key = key;
+    rateLimit[slot].acceptedAt = millis();
 }
 
+uint32_t ThingSpeakClass::hashKey(const char *APIKey) {
+    // FNV-1a, 0 is left for unused entries
+    uint32_t hash = 2166136261u;
+    for(; APIKey != NULL && *APIKey != '\0'; APIKey++){
+        hash = (hash ^ (uint8_t)*APIKey) * 16777619u;
+    }
+
+    return hash | 1;
+}
+
+int ThingSpeakClass::sendRequest() {
+    int status = TS_ERR_UNEXPECTED_FAIL;
+    const char *key = this->requestKey[0] != '\0' ? this->requestKey : NULL;
+
+    if(this->requestKind == REQUEST_WRITE){
+        status = postFields(key);
+    }
+#ifndef ARDUINO_AVR_UNO
+    else if(this->requestKind == REQUEST_BULK){
+        status = postBulk(this->requestChannel, key);
+    }
+#endif
+    else if(this->requestKind == REQUEST_READ){
+        char readURL[40];  // /channels/4294967295/fields/8/last
+        sprintf(readURL, "/channels/%lu/fields/%u/last", this->requestChannel, this->requestField);
+        status = postRead(readURL, key);
+    }
+
+    if(status == TS_OK_SUCCESS){
+        startResponse();
+    }
+
+    return status;
+}
+
+int ThingSpeakClass::waitForRequest() {
+    // Only for the request in progress, a write held back by beginWrite() doesn't hold up the caller
+    while(this->requestKind != REQUEST_NONE && pollRequest()){
+        delay(2);
+    }
+
+    return this->requestStatus;
+}
+
+int ThingSpeakClass::completeRequest(int status) {
+    this->response[0] = '\0';
+    if(status == TS_OK_SUCCESS || status == TS_OK_ACCEPTED){
+        size_t length = this->client->readBytes(this->response, min(this->responseContentLength, TS_RESPONSE_BUFFER_SIZE - 1));
+        this->response[length] = '\0';
+        emptyStream();
+        endRequest();
+    }
+    else{
+        emptyStream();
+        this->client->stop();
+        this->keepAlive = false;
+    }
+
+    if(this->requestKind == REQUEST_WRITE){
+        if(status == TS_OK_SUCCESS){
+#ifdef PRINT_DEBUG_MESSAGES
+            Serial.print("               Entry ID \"");Serial.print(this->response);Serial.println("\"");
+#endif
+            // The body is just the entry ID, 0 if ThingSpeak did not accept the write
+            if(atol(this->response) == 0) status = TS_ERR_NOT_INSERTED;
+            else setRateLimitWrite(this->requestKeyHash);
+        }
+        resetWriteFields();
+    }
+#ifndef ARDUINO_AVR_UNO
+    else if(this->requestKind == REQUEST_BULK){
+        if(status == TS_OK_ACCEPTED) status = TS_OK_SUCCESS;
+        if(status == TS_OK_SUCCESS){
+            clearBulk();
+            setRateLimitWrite(this->requestKeyHash);
+        }
+    }
+#endif
+    else if(this->requestKind == REQUEST_READ){
+        this->lastReadStatus = status;
+    }
+
+    // The callback may start the next request right away
+    this->requestKind = REQUEST_NONE;
+    this->requestStatus = status;
+    if(this->requestCallback != NULL){
+        this->requestCallback(status, this->response);
+    }
+
+    return status;
+}
+
+
 String ThingSpeakClass::readRaw(unsigned long channelNumber, String suffixURL) {
     return readRaw(channelNumber, suffixURL, NULL);
 }
@@ -462,27 +1247,72 @@ String ThingSpeakClass::readRaw(unsigned long channelNumber, String suffixURL) {
 #ifndef ARDUINO_AVR_UNO //No Arduino here ----------
 
 int ThingSpeakClass::readMultipleFields(unsigned long channelNumber, const char *readAPIKey) {
-    String readCondition = "/feeds/last.txt?status=true&location=true";
+    if(this->requestKind != REQUEST_NONE){
+        this->lastReadStatus = TS_ERR_BUSY;
+        return TS_ERR_BUSY;
+    }
 
-    String multiContent = readRaw(channelNumber, readCondition, readAPIKey);
+    char readURL[64];
+    sprintf(readURL, "/channels/%lu/feeds/last.txt?status=true&location=true", channelNumber);
 
-    if(getLastReadStatus() != TS_OK_SUCCESS){
+    int contentLength = 0;
+    bool ok = requestRaw(readURL, readAPIKey, contentLength);
+    if(!ok && this->lastReadStatus == TS_ERR_CONNECTION_CLOSED){
+        // The server closed the kept-alive connection in the meantime, ask once more on a fresh one
+        ok = requestRaw(readURL, readAPIKey, contentLength);
+    }
+    if(!ok){
         return getLastReadStatus();
     }
 
-    this->lastFeed.nextReadField[0] = parseValues(multiContent, "field1");
-    this->lastFeed.nextReadField[1] = parseValues(multiContent, "field2");
-    this->lastFeed.nextReadField[2] = parseValues(multiContent, "field3");
-    this->lastFeed.nextReadField[3] = parseValues(multiContent, "field4");
-    this->lastFeed.nextReadField[4] = parseValues(multiContent, "field5");
-    this->lastFeed.nextReadField[5] = parseValues(multiContent, "field6");
-    this->lastFeed.nextReadField[6] = parseValues(multiContent, "field7");
-    this->lastFeed.nextReadField[7] = parseValues(multiContent, "field8");
-    this->lastFeed.nextReadCreatedAt = parseValues(multiContent, "created_at");
-    this->lastFeed.nextReadLatitude = parseValues(multiContent, "latitude");
-    this->lastFeed.nextReadLongitude = parseValues(multiContent, "longitude");
-    this->lastFeed.nextReadElevation = parseValues(multiContent, "elevation");
-    this->lastFeed.nextReadStatus = parseValues(multiContent, "status");
+    // Keep as much of the feed as fits, the values are found in place
+    char *text = this->lastFeed.text;
+    size_t length = this->client->readBytes(text, min(contentLength, TS_FEED_BUFFER_SIZE - 1));
+    text[length] = '\0';
+
+    emptyStream();
+    endRequest();
+
+#ifdef PRINT_DEBUG_MESSAGES
+    Serial.print("Read: \""); Serial.print(text); Serial.println("\"");
+#endif
+
+    static const char * const keys[] = {"field1", "field2", "field3", "field4", "field5", "field6", "field7", "field8",
+                                        "created_at", "latitude", "longitude", "elevation", "status"};
+    uint16_t * const values[] = {&this->lastFeed.nextReadField[0], &this->lastFeed.nextReadField[1], &this->lastFeed.nextReadField[2],
+                                 &this->lastFeed.nextReadField[3], &this->lastFeed.nextReadField[4], &this->lastFeed.nextReadField[5],
+                                 &this->lastFeed.nextReadField[6], &this->lastFeed.nextReadField[7], &this->lastFeed.nextReadCreatedAt,
+                                 &this->lastFeed.nextReadLatitude, &this->lastFeed.nextReadLongitude, &this->lastFeed.nextReadElevation,
+                                 &this->lastFeed.nextReadStatus};
+    uint16_t ends[sizeof(keys) / sizeof(keys[0])];
+
+    // Find all values first, terminating them would hide the keys behind
+    for(size_t iKey = 0; iKey < sizeof(keys) / sizeof(keys[0]); iKey++){
+        *values[iKey] = length;  // points at the terminator, an empty value
+        ends[iKey] = length;
+
+        char searchPhrase[16];  // "created_at":"
+        sprintf(searchPhrase, "\"%s\":\"", keys[iKey]);
+        const char *from = strstr(text, searchPhrase);
+        if(from == NULL){
+            // there is no such value or it's null
+            continue;
+        }
+        from += strlen(searchPhrase);
+
+        const char *to = strchr(from, '"');
+        if(to == NULL){
+            // there is no end quote
+            continue;
+        }
+
+        *values[iKey] = from - text;
+        ends[iKey] = to - text;
+    }
+
+    for(size_t iKey = 0; iKey < sizeof(keys) / sizeof(keys[0]); iKey++){
+        text[ends[iKey]] = '\0';
+    }
 
     return TS_OK_SUCCESS;
 }
@@ -499,7 +1329,7 @@ String ThingSpeakClass::getFieldAsString(unsigned int field) {
     }
 
     this->lastReadStatus = TS_OK_SUCCESS;
-    return this->lastFeed.nextReadField[field-1];
+    return String(this->lastFeed.text + this->lastFeed.nextReadField[field-1]);
 }
 
 float ThingSpeakClass::getFieldAsFloat(unsigned int field) {
@@ -517,23 +1347,23 @@ int ThingSpeakClass::getFieldAsInt(unsigned int field) {
 }
 
 String ThingSpeakClass::getStatus() {
-    return this->lastFeed.nextReadStatus;
+    return String(this->lastFeed.text + this->lastFeed.nextReadStatus);
 }
 
 String ThingSpeakClass::getLatitude() {
-    return this->lastFeed.nextReadLatitude;
+    return String(this->lastFeed.text + this->lastFeed.nextReadLatitude);
 }
 
 String ThingSpeakClass::getLongitude() {
-    return this->lastFeed.nextReadLongitude;
+    return String(this->lastFeed.text + this->lastFeed.nextReadLongitude);
 }
 
 String ThingSpeakClass::getElevation() {
-    return this->lastFeed.nextReadElevation;
+    return String(this->lastFeed.text + this->lastFeed.nextReadElevation);
 }
 
 String ThingSpeakClass::getCreatedAt() {
-    return this->lastFeed.nextReadCreatedAt;
+    return String(this->lastFeed.text + this->lastFeed.nextReadCreatedAt);
 }
 
 #endif //Arduino from here on again ----------
@@ -542,60 +1372,11 @@ int ThingSpeakClass::getLastReadStatus() {
     return this->lastReadStatus;
 }
 
-int ThingSpeakClass::getWriteFieldsContentLength() {
-    size_t iField;
-    int contentLen = 0;
-
-    for(iField = 0; iField < FIELDNUM_MAX; iField++){
-        if(this->nextWriteField[iField].length() > 0){
-            contentLen = contentLen + 8 + this->nextWriteField[iField].length();	// &fieldX=[value]
-
-            // future-proof in case ThingSpeak allows 999 fields someday
-            if(iField > 9){
-                contentLen = contentLen + 1;
-            }
-            else if(iField > 99){
-                contentLen = contentLen + 2;
-            }
-
-        }
-    }
-
-    if(!isnan(this->nextWriteLatitude)){
-        contentLen = contentLen + 5 + String(this->nextWriteLatitude).length(); // &lat=[value]
-    }
-
-    if(!isnan(this->nextWriteLongitude)){
-        contentLen = contentLen + 6 + String(this->nextWriteLongitude).length(); // &long=[value]
-    }
-
-    if(!isnan(this->nextWriteElevation)){
-        contentLen = contentLen + 11 + String(this->nextWriteElevation).length(); // &elevation=[value]
-    }
-
-    if(this->nextWriteStatus.length() > 0){
-        contentLen = contentLen + 8 + this->nextWriteStatus.length();	// &status=[value]
-    }
-
-    if(this->nextWriteTwitter.length() > 0){
-        contentLen = contentLen + 9 + this->nextWriteTwitter.length();	// &twitter=[value]
-    }
-
-    if(this->nextWriteTweet.length() > 0){
-        contentLen = contentLen + 7 + this->nextWriteTweet.length();	// &tweet=[value]
-    }
-
-    if(this->nextWriteCreatedAt.length() > 0){
-        contentLen = contentLen + 12 + this->nextWriteCreatedAt.length();	// &created_at=[value]
-    }
-
-    if(contentLen == 0){
-        return 0;
-    }
-
-    contentLen = contentLen + 13; // add 14 for '&headers=false', subtract 1 for missing first '&'
-
-    return contentLen;
+bool ThingSpeakClass::hasWriteValues() {
+    return this->writeUsed > 0
+        || !isnan(this->nextWriteLatitude)
+        || !isnan(this->nextWriteLongitude)
+        || !isnan(this->nextWriteElevation);
 }
 
 void ThingSpeakClass::emptyStream() {
@@ -605,8 +1386,16 @@ void ThingSpeakClass::emptyStream() {
 }
 
 int ThingSpeakClass::finishWrite() {
-    String entryIDText = String();
-    int status = getHTTPResponse(entryIDText);
+    int contentLength = 0;
+    int status = getHTTPResponse(contentLength);
+
+    // The body is just the entry ID
+    char entryIDText[16];
+    size_t length = 0;
+    if(status == TS_OK_SUCCESS){
+        length = this->client->readBytes(entryIDText, min(contentLength, (int)sizeof(entryIDText) - 1));
+    }
+    entryIDText[length] = '\0';
 
     emptyStream();
 
@@ -615,17 +1404,14 @@ int ThingSpeakClass::finishWrite() {
         this->client->stop();
         return status;
     }
-    long entryID = entryIDText.toInt();
+    long entryID = atol(entryIDText);
 
 #ifdef PRINT_DEBUG_MESSAGES
     Serial.print("               Entry ID \"");Serial.print(entryIDText);Serial.print("\" (");Serial.print(entryID);Serial.println(")");
 #endif
 
-    this->client->stop();
+    endRequest();
 
-#ifdef PRINT_DEBUG_MESSAGES
-    Serial.println("disconnected.");
-#endif
     if(entryID == 0)
     {
         // ThingSpeak did not accept the write
@@ -666,47 +1452,15 @@ String ThingSpeakClass::getJSONValueByKey(String textToSearch, String key) {
     return textToSearch.substring(fromPosition);
 }
 
-#ifndef ARDUINO_AVR_UNO
-
-String ThingSpeakClass::parseValues(String &multiContent, String key) {
-    if(multiContent.length() == 0){
-        return String("");
-    }
-
-    String searchPhrase = String("\"");
-    searchPhrase.concat(key);
-    searchPhrase.concat("\":\"");
-
-    int fromPosition = multiContent.indexOf(searchPhrase,0);
-
-    if(fromPosition == -1){
-        // return because there is no status or it's null
-        return String("");
-    }
-
-    fromPosition = fromPosition + searchPhrase.length();
-
-    int toPosition = multiContent.indexOf("\"", fromPosition);
-
-
-    if(toPosition == -1){
-        // return because there is no end quote
-        return String("");
-    }
-
-    return multiContent.substring(fromPosition, toPosition);
-}
-
-#endif
-
 int ThingSpeakClass::abortWriteRaw() {
     while(this->client->available() > 0){
         this->client->read();
     }
     this->client->stop();
-    resetWriteFields();
+    this->keepAlive = false;
 
-    return TS_ERR_UNEXPECTED_FAIL;
+    // A reused connection most likely failed because the server closed it while idle
+    return this->reusedConnection ? TS_ERR_CONNECTION_CLOSED : TS_ERR_UNEXPECTED_FAIL;
 }
 
 String ThingSpeakClass::abortReadRaw() {
@@ -714,13 +1468,27 @@ String ThingSpeakClass::abortReadRaw() {
         this->client->read();
     }
     this->client->stop();
+    this->keepAlive = false;
 #ifdef PRINT_DEBUG_MESSAGES
     Serial.println("ReadRaw abort - disconnected.");
 #endif
-    this->lastReadStatus = TS_ERR_UNEXPECTED_FAIL;
+    // A reused connection most likely failed because the server closed it while idle
+    this->lastReadStatus = this->reusedConnection ? TS_ERR_CONNECTION_CLOSED : TS_ERR_UNEXPECTED_FAIL;
     return String("");
 }
 
+void ThingSpeakClass::endRequest() {
+    if(this->keepAlive){
+        // Leave the connection open for the next request
+        return;
+    }
+
+    this->client->stop();
+#ifdef PRINT_DEBUG_MESSAGES
+    Serial.println("disconnected.");
+#endif
+}
+
 void ThingSpeakClass::setPort(unsigned int port) {
     this->port = port;
 }
@@ -732,6 +1500,22 @@ void ThingSpeakClass::setClient(Client *client) {
 bool ThingSpeakClass::connectThingSpeak() {
     bool connectSuccess = false;
 
+    // Reuse the connection the server kept open after the previous response
+    if(this->keepAlive && this->client->connected()){
+#ifdef PRINT_DEBUG_MESSAGES
+        Serial.println("               Reusing connection to ThingSpeak");
+#endif
+        this->reusedConnection = true;
+        return true;
+    }
+
+    // The server may have closed a kept-alive connection, release it before connecting again
+    if(this->keepAlive){
+        this->client->stop();
+        this->keepAlive = false;
+    }
+    this->reusedConnection = false;
+
 #ifdef PRINT_DEBUG_MESSAGES
     Serial.print("               Connect to default ThingSpeak: ");
                 Serial.print(THINGSPEAK_URL);
@@ -756,115 +1540,150 @@ bool ThingSpeakClass::connectThingSpeak() {
     return connectSuccess;
 }
 
-bool ThingSpeakClass::writeHTTPHeader(const char *APIKey) {
+int ThingSpeakClass::getHTTPResponse(int &contentLength) {
+    startResponse();
 
-    if (!this->client->print("Host: api.thingspeak.com\r\n")) return false;
-    if (!this->client->print("User-Agent: ")) return false;
-    if (!this->client->print(TS_USER_AGENT)) return false;
-    if (!this->client->print("\r\n")) return false;
-    if(NULL != APIKey)
-    {
-        if (!this->client->print("X-THINGSPEAKAPIKEY: ")) return false;
-        if (!this->client->print(APIKey)) return false;
-        if (!this->client->print("\r\n")) return false;
+    int status;
+    while((status = pollResponse()) == RESPONSE_PENDING){
+        delay(2);
     }
 
-    return true;
+    contentLength = this->responseContentLength;
+    return status;
 }
 
-int ThingSpeakClass::getHTTPResponse(String &response) {
+void ThingSpeakClass::startResponse() {
     // make sure all of the HTTP request is pushed out of the buffer before looking for a response
     this->client->flush();
 
-    long timeoutTime = millis() + TIMEOUT_MS_SERVERRESPONSE;
+    // Only keep the connection if this response allows it
+    this->keepAlive = false;
 
-    while(this->client-> available() < 17){
-        delay(2);
-        if(millis() > timeoutTime){
-            return TS_ERR_TIMEOUT;
+    this->responseState = RESPONSE_STATUS_LINE;
+    this->responseLineLength = 0;
+    this->responseContentLength = -1;
+    this->responsePersistent = false;
+    this->responseStarted = false;
+    this->responseDeadline = millis() + TIMEOUT_MS_SERVERRESPONSE;
+}
+
+int ThingSpeakClass::pollResponse() {
+    // Take what has arrived line by line, without waiting for more
+    while(this->responseState != RESPONSE_BODY && this->client->available() > 0){
+        char c = this->client->read();
+        this->responseStarted = true;
+        if(c != '\n'){
+            // the rest of longer lines is skipped, the headers we look at are short
+            if(this->responseLineLength < sizeof(this->responseLine) - 1){
+                this->responseLine[this->responseLineLength++] = c;
+            }
+            continue;
+        }
+
+        if(this->responseLineLength > 0 && this->responseLine[this->responseLineLength - 1] == '\r'){
+            this->responseLineLength--;
         }
+        this->responseLine[this->responseLineLength] = '\0';
+        this->responseLineLength = 0;
+
+        int status = parseResponseLine();
+        if(status != RESPONSE_PENDING) return status;
     }
 
-    if(!this->client->find(const_cast<char *>("HTTP/1.1")))
-    {
-#ifdef PRINT_HTTP
-        Serial.println("ERROR: Didn't find HTTP/1.1");
-#endif
-        return TS_ERR_BAD_RESPONSE; // Couldn't parse response (didn't find HTTP/1.1)
+    if(this->responseState == RESPONSE_BODY && this->client->available() >= this->responseContentLength){
+        // The body is left to the caller, after it the connection is ready for the next request
+        this->keepAlive = this->responsePersistent;
+        return this->responseStatus;
     }
 
-    int status = this->client->parseInt();
-#ifdef PRINT_HTTP
-    Serial.print("Got Status of ");Serial.println(status);
-#endif
-    if(status != TS_OK_SUCCESS)
-    {
-        return status;
+    if(!this->client->connected() && this->client->available() == 0){
+        // Closed without an answer, usually an idle kept-alive connection
+        return this->responseStarted ? TS_ERR_BAD_RESPONSE : TS_ERR_CONNECTION_CLOSED;
     }
 
-    // Find Content-Length
-    if(!this->client->find(const_cast<char *>("Content-Length:"))){
-#ifdef PRINT_HTTP
-        Serial.println("ERROR: Didn't find Content-Length header");
-#endif
-        return TS_ERR_BAD_RESPONSE; // Couldn't parse response (didn't find HTTP/1.1)
+    if((long)(millis() - this->responseDeadline) >= 0){
+        return TS_ERR_TIMEOUT;
     }
-    int contentLength = this->client->parseInt();
 
+    return RESPONSE_PENDING;
+}
+
+int ThingSpeakClass::parseResponseLine() {
+    char *line = this->responseLine;
+
+    if(this->responseState == RESPONSE_STATUS_LINE){
+        if(strncmp(line, "HTTP/1.", 7) != 0)
+        {
 #ifdef PRINT_HTTP
-    Serial.print("Content Length: ");
-                Serial.println(contentLength);
+            Serial.println("ERROR: Didn't find HTTP/1.1");
 #endif
+            return TS_ERR_BAD_RESPONSE; // Couldn't parse response (didn't find HTTP/1.1)
+        }
 
-    if(!this->client->find(const_cast<char *>("\r\n\r\n")))
-    {
+        // HTTP/1.1 keeps the connection open unless told otherwise, HTTP/1.0 closes it
+        this->responsePersistent = (line[7] == '1');
+
+        this->responseStatus = atoi(line + 8);
 #ifdef PRINT_HTTP
-        Serial.println("ERROR: Didn't find end of headers");
+        Serial.print("Got Status of ");Serial.println(this->responseStatus);
 #endif
-        return TS_ERR_BAD_RESPONSE;
+        if(this->responseStatus != TS_OK_SUCCESS && this->responseStatus != TS_OK_ACCEPTED)
+        {
+            return this->responseStatus;
+        }
+
+        this->responseState = RESPONSE_HEADERS;
+        return RESPONSE_PENDING;
     }
+
+    // The empty line ends the headers
+    if(line[0] == '\0'){
+        if(this->responseContentLength < 0){
 #ifdef PRINT_HTTP
-    Serial.println("Found end of header");
+            Serial.println("ERROR: Didn't find Content-Length header");
 #endif
-
-    timeoutTime = millis() + TIMEOUT_MS_SERVERRESPONSE;
-
-    while(this->client->available() < contentLength){
-        delay(2);
-        if(millis() > timeoutTime){
-            return TS_ERR_TIMEOUT;
+            return TS_ERR_BAD_RESPONSE; // Without it the end of the body is unknown
         }
-    }
-
-    String tempString = String("");
-    char y = 0;
-    for(int i = 0; i < contentLength; i++){
-        y = client->read();
-        tempString.concat(y);
-    }
-    response = tempString;
 
 #ifdef PRINT_HTTP
-    Serial.print("Response: \"");Serial.print(response);Serial.println("\"");
+        Serial.print("Content Length: ");
+                    Serial.println(this->responseContentLength);
+        Serial.println("Found end of header");
 #endif
+        this->responseState = RESPONSE_BODY;
+        this->responseDeadline = millis() + TIMEOUT_MS_SERVERRESPONSE;
+        return RESPONSE_PENDING;
+    }
 
-    return status;
+    // Header names and the values we look for are case-insensitive
+    for(char *c = line; *c != '\0'; c++){
+        *c = tolower(*c);
+    }
+    if(strncmp(line, "content-length:", 15) == 0){
+        this->responseContentLength = atoi(line + 15);
+    }
+    else if(strncmp(line, "connection:", 11) == 0){
+        if(strstr(line + 11, "close") != NULL){
+            this->responsePersistent = false;
+        }
+        else if(strstr(line + 11, "keep-alive") != NULL){
+            this->responsePersistent = true;
+        }
+    }
+
+    return RESPONSE_PENDING;
 }
 
-int ThingSpeakClass::convertFloatToChar(float value, char *valueString) {
+int ThingSpeakClass::convertFloatToChar(float value, char *valueString, unsigned int decimals) {
     // Supported range is -999999000000 to 999999000000
     if(0 == isinf(value) && (value > 999999000000 || value < -999999000000))
     {
         // Out of range
         return TS_ERR_OUT_OF_RANGE;
     }
-    // assume that 5 places right of decimal should be sufficient for most applications
+    if(decimals > TS_FLOAT_DECIMALS_MAX) return TS_ERR_OUT_OF_RANGE;
 
-#if defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_ARCH_SAM)
-    sprintf(valueString, "%.5f", value);
-#else
-    dtostrf(value,1,5, valueString);
-#endif
+    formatFixed(value, decimals, valueString);
 
     return TS_OK_SUCCESS;
 }
@@ -882,15 +1701,59 @@ float ThingSpeakClass::convertStringToFloat(String value) {
 }
 
 void ThingSpeakClass::resetWriteFields() {
-    for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
+    for(size_t slot = 0; slot < WRITE_SLOTS; slot++)
     {
-        this->nextWriteField[iField] = "";
+        this->writeStart[slot] = 0;
+        this->writeLength[slot] = 0;
     }
+    this->writeUsed = 0;
     this->nextWriteLatitude = NAN;
     this->nextWriteLongitude = NAN;
     this->nextWriteElevation = NAN;
-    this->nextWriteStatus = "";
-    this->nextWriteTwitter = "";
-    this->nextWriteTweet = "";
-    this->nextWriteCreatedAt = "";
+}
+
+int ThingSpeakClass::setWriteValue(size_t slot, const char *value, size_t length) {
+    // The values of a write in progress are still needed and get cleared when it's done,
+    // a write held back by the rate limit takes the new ones along (the last value set wins)
+    if(this->requestKind == REQUEST_WRITE) return TS_ERR_BUSY;
+
+    // Max # bytes for ThingSpeak field is 255 (UTF-8)
+    if(length > FIELDLENGTH_MAX) return TS_ERR_OUT_OF_RANGE;
+
+    // The old value makes room first, a value that doesn't fit leaves it in place
+    size_t oldSize = this->writeLength[slot] > 0 ? this->writeLength[slot] + 1 : 0;
+    size_t newSize = length > 0 ? length + 1 : 0;
+    if(this->writeUsed - oldSize + newSize > TS_WRITE_BUFFER_SIZE) return TS_ERR_OUT_OF_RANGE;
+
+    clearWriteValue(slot);
+    if(length > 0){
+        memcpy(this->writeBuffer + this->writeUsed, value, length);
+        this->writeBuffer[this->writeUsed + length] = '\0';
+        this->writeStart[slot] = this->writeUsed;
+        this->writeLength[slot] = length;
+        this->writeUsed += newSize;
+    }
+
+    return TS_OK_SUCCESS;
+}
+
+void ThingSpeakClass::clearWriteValue(size_t slot) {
+    if(this->writeLength[slot] == 0) return;
+
+    // Close the gap, the values behind it move down
+    size_t start = this->writeStart[slot];
+    size_t size = this->writeLength[slot] + 1;
+    memmove(this->writeBuffer + start, this->writeBuffer + start + size, this->writeUsed - start - size);
+    for(size_t other = 0; other < WRITE_SLOTS; other++){
+        if(this->writeLength[other] > 0 && this->writeStart[other] > start){
+            this->writeStart[other] -= size;
+        }
+    }
+    this->writeUsed -= size;
+    this->writeStart[slot] = 0;
+    this->writeLength[slot] = 0;
+}
+
+const char * ThingSpeakClass::getWriteValue(size_t slot) {
+    return this->writeLength[slot] > 0 ? this->writeBuffer + this->writeStart[slot] : "";
 }
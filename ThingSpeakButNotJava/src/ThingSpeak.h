@@ -22,6 +22,7 @@
 
     #include "Arduino.h"
     #include <Client.h>
+    #include <limits.h>
 
     #define THINGSPEAK_URL "api.thingspeak.com"
     #define THINGSPEAK_PORT_NUMBER 80
@@ -57,41 +58,165 @@
     #define FIELDNUM_MAX 8
     #define FIELDLENGTH_MAX 255  // Max length for a field in ThingSpeak is 255 bytes (UTF-8)
 
+    #ifndef TS_FLOAT_DECIMALS
+        #define TS_FLOAT_DECIMALS 5  // Decimals a float is written with unless setFieldPrecision() says otherwise
+    #endif
+    #define TS_FLOAT_DECIMALS_MAX 5
+    static_assert(TS_FLOAT_DECIMALS <= TS_FLOAT_DECIMALS_MAX, "TS_FLOAT_DECIMALS can be 5 at most");
+
     #define TIMEOUT_MS_SERVERRESPONSE 5000  // Wait up to five seconds for server to respond
 
+    #ifndef TS_REQUEST_BUFFER_SIZE
+        #ifdef ARDUINO_AVR_UNO
+            #define TS_REQUEST_BUFFER_SIZE 128  // Stack buffer a request is collected in before it is written
+        #else
+            #define TS_REQUEST_BUFFER_SIZE 512  // Stack buffer a request is collected in before it is written
+        #endif
+    #endif
+
+    #ifndef TS_WRITE_BUFFER_SIZE
+        #ifdef ARDUINO_AVR_UNO
+            #define TS_WRITE_BUFFER_SIZE 128   // Values set for the next writeFields() or addBulkEntry(), stored back to back
+        #else
+            #define TS_WRITE_BUFFER_SIZE 1024  // Values set for the next writeFields() or addBulkEntry(), stored back to back
+        #endif
+    #endif
+
+    #ifndef TS_WRITE_BODY_SIZE
+        #define TS_WRITE_BODY_SIZE (TS_WRITE_BUFFER_SIZE + 192)  // Stack buffer writeFields() puts the body (the values plus their keys) and the headers in front of it together in
+    #endif
+
+    #ifndef TS_FEED_BUFFER_SIZE
+        #define TS_FEED_BUFFER_SIZE 512  // Body of the feed read by readMultipleFields(), longer feeds lose their last values
+    #endif
+
+    #ifndef TS_RESPONSE_BUFFER_SIZE
+        #ifdef ARDUINO_AVR_UNO
+            #define TS_RESPONSE_BUFFER_SIZE 32   // Body of a response handed to the callback of beginWrite(), beginRead() ...
+        #else
+            #define TS_RESPONSE_BUFFER_SIZE 256  // Body of a response handed to the callback of beginWrite(), beginRead() ...
+        #endif
+    #endif
+
+    #ifndef TS_BULK_BUFFER_SIZE
+        #define TS_BULK_BUFFER_SIZE 1024  // Bytes of serialized JSON entries held for one bulk update
+    #endif
+
+    #ifndef TS_RATE_LIMIT_MS
+        #define TS_RATE_LIMIT_MS 15000  // Shortest time between two writes to a channel that ThingSpeak accepts (1000 with a paid license)
+    #endif
+
+    #ifndef TS_RATE_LIMIT_KEYS
+        #ifdef ARDUINO_AVR_UNO
+            #define TS_RATE_LIMIT_KEYS 2  // Write API keys whose last accepted write is remembered for the rate limit
+        #else
+            #define TS_RATE_LIMIT_KEYS 4  // Write API keys whose last accepted write is remembered for the rate limit
+        #endif
+    #endif
+
+    #define TS_API_KEY_LENGTH 16  // Characters of a ThingSpeak API key, requests keep a copy
+
     #define TS_OK_SUCCESS              200     // OK / Success
+    #define TS_OK_ACCEPTED             202     // Bulk update accepted (reported as TS_OK_SUCCESS by writeBulk)
     #define TS_ERR_BADAPIKEY           400     // Incorrect API key (or invalid ThingSpeak server address)
     #define TS_ERR_BADURL              404     // Incorrect API key (or invalid ThingSpeak server address)
-    #define TS_ERR_OUT_OF_RANGE        -101    // Value is out of range or string is too long (> 255 bytes)
+    #define TS_ERR_OUT_OF_RANGE        -101    // Value is out of range or string is too long (> 255 bytes or no room left in the write buffer)
+    #define TS_ERR_BULK_FULL           -102    // No room left in the bulk buffer, call writeBulk() first
     #define TS_ERR_INVALID_FIELD_NUM   -201    // Invalid field number specified
     #define TS_ERR_SETFIELD_NOT_CALLED -210    // setField() was not called before writeFields()
     #define TS_ERR_CONNECT_FAILED      -301    // Failed to connect to ThingSpeak
     #define TS_ERR_UNEXPECTED_FAIL     -302    // Unexpected failure during write to ThingSpeak
     #define TS_ERR_BAD_RESPONSE        -303    // Unable to parse response
     #define TS_ERR_TIMEOUT             -304    // Timeout waiting for server to respond
+    #define TS_ERR_CONNECTION_CLOSED   -305    // Server closed the connection without responding
+    #define TS_ERR_BUSY                -306    // Another request is still in progress, call poll() until it is done
     #define TS_ERR_NOT_INSERTED        -401    // Point was not inserted (most probable cause is the rate limit of once every 15 seconds)
 
     
     // variables to store the values from the readMultipleFields functionality
+    // (the values stay in the received text, terminated in place, and are found by their offsets)
     #ifndef ARDUINO_AVR_UNO
         typedef struct feedRecord
         {
-            String nextReadField[8];
-            String nextReadStatus;
-            String nextReadLatitude;
-            String nextReadLongitude;
-            String nextReadElevation;
-            String nextReadCreatedAt;
+            char text[TS_FEED_BUFFER_SIZE];
+            uint16_t nextReadField[8];
+            uint16_t nextReadStatus;
+            uint16_t nextReadLatitude;
+            uint16_t nextReadLongitude;
+            uint16_t nextReadElevation;
+            uint16_t nextReadCreatedAt;
         }feed;
     #endif
 
 
+    // Called when a request started with beginWrite(), beginWriteBulk() or beginRead() is done.
+    // status is what the blocking function would have returned, response the body (the entry ID of a write, the value of a read).
+    typedef void (*ThingSpeakCallback)(int status, const char * response);
+
+
+    // Compile time parts of write<fields...>(): the keys of the body and how much room the values may take
+    template<unsigned int field>
+    struct TSFieldKey {
+        static constexpr char text[] = {'&', 'f', 'i', 'e', 'l', 'd', char('0' + field), '=', '\0'};
+    };
+
+    template<unsigned int field>
+    constexpr char TSFieldKey<field>::text[];
+
+    template<unsigned int... fields>
+    struct TSFieldList {
+        static constexpr bool inRange = true;
+        static constexpr bool distinct = true;
+        static constexpr bool contains(unsigned int) { return false; }
+    };
+
+    template<unsigned int field, unsigned int... rest>
+    struct TSFieldList<field, rest...> {
+        static constexpr bool inRange = field >= FIELDNUM_MIN && field <= FIELDNUM_MAX && TSFieldList<rest...>::inRange;
+        static constexpr bool distinct = !TSFieldList<rest...>::contains(field) && TSFieldList<rest...>::distinct;
+        static constexpr bool contains(unsigned int other) { return other == field || TSFieldList<rest...>::contains(other); }
+    };
+
+    template<typename Value>
+    struct TSValueSize;  // only the types write<>() can format have a size
+    // Sign and digits of the most negative value: 6 for a 16 bit int, 11 for 32 bits, 20 for 64 bits.
+    // std::numeric_limits isn't there on AVR, so the digits come from the bits (log10(2) = 0.30103).
+    template<typename Integer>
+    struct TSIntegerSize {
+        static constexpr size_t value = (sizeof(Integer) * CHAR_BIT - 1) * 30103UL / 100000UL + 2;
+    };
+    template<> struct TSValueSize<int> { static constexpr size_t value = TSIntegerSize<int>::value; };
+    template<> struct TSValueSize<long> { static constexpr size_t value = TSIntegerSize<long>::value; };
+    template<> struct TSValueSize<float> { static constexpr size_t value = 19; };  // -999999000000.00000
+    template<> struct TSValueSize<double> { static constexpr size_t value = 19; };
+    template<> struct TSValueSize<const char *> { static constexpr size_t value = FIELDLENGTH_MAX; };
+    template<> struct TSValueSize<char *> { static constexpr size_t value = FIELDLENGTH_MAX; };
+    template<> struct TSValueSize<String> { static constexpr size_t value = FIELDLENGTH_MAX; };
+
+    template<typename... Values>
+    struct TSBodySize {
+        static constexpr size_t value = sizeof("&headers=false") - 1;
+    };
+
+    template<typename Value, typename... Values>
+    struct TSBodySize<Value, Values...> {
+        static constexpr size_t value = sizeof(TSFieldKey<1>::text) - 1 + TSValueSize<Value>::value + TSBodySize<Values...>::value;
+    };
+
+
     // Enables an Arduino, ESP8266, ESP32 or other compatible hardware to write or read data to or from ThingSpeak, an open data platform for the Internet of Things with MATLAB analytics and visualization.
+    // Every instance has its own client, pending values, bulk buffer, read feed and request; instances don't interfere.
+    // Only the rate limit table is shared, ThingSpeak counts the window per key whichever instance writes.
+    // The constant parts (HTTP headers, format tables) are shared in flash. See "Several Instances" in README.md for the RAM each one takes.
     class ThingSpeakClass
     {
       public:
         ThingSpeakClass();
 
+        // An instance owns its request and buffers, a copy would share the connection
+        ThingSpeakClass(const ThingSpeakClass &) = delete;
+        ThingSpeakClass & operator=(const ThingSpeakClass &) = delete;
+
 
         /*
         Function: begin
@@ -151,7 +276,10 @@
         
         Returns:
         Code of 200 if successful.
-        Code of -101 if value is out of range or string is too long (> 255 bytes)
+        Code of -101 if value is out of range or string is too long (> 255 bytes or no room left in the write buffer)
+
+        Notes:
+        The values are kept in a buffer of TS_WRITE_BUFFER_SIZE bytes inside the object, so setting them doesn't use the heap.
         */
         int setField(unsigned int field, int value);
 
@@ -159,8 +287,31 @@
 
         int setField(unsigned int field, float value);
 
+        int setField(unsigned int field, const char * value);
+
         int setField(unsigned int field, String value);
 
+
+        /*
+        Function: setFieldPrecision
+
+        Summary:
+        Set the number of decimals float values of a field are written with.
+
+        Parameters:
+        field - Field number (1-8) within the channel.
+        decimals - Decimals right of the decimal point (0-5), trailing zeros are left out.
+
+        Returns:
+        Code of 200 if successful.
+        Code of -101 if decimals is more than 5
+        Code of -201 if the field number is invalid
+
+        Notes:
+        Applies to setField() and writeField() with a float value. The default is TS_FLOAT_DECIMALS (5).
+        */
+        int setFieldPrecision(unsigned int field, unsigned int decimals);
+
          
         /*
         Function: setLatitude
@@ -235,6 +386,8 @@
         Use status to provide additonal details when writing a channel update.
         Additonally, status can be used by the ThingTweet App to send a message to Twitter.
         */
+        int setStatus(const char * status);
+
         int setStatus(String status);
         
 
@@ -256,6 +409,8 @@
         To send a message to twitter call setTwitterTweet() then call writeFields().
         Prior to using this feature, a twitter account must be linked to your ThingSpeak account. Do this by logging into ThingSpeak and going to Apps, then ThingTweet and clicking Link Twitter Account.
         */
+        int setTwitterTweet(const char * twitter, const char * tweet);
+
         int setTwitterTweet(String twitter, String tweet);
         
             
@@ -276,6 +431,8 @@
         Timezones can be set using the timezone hour offset parameter. For example, a timestamp for Eastern Standard Time is: "2017-01-12 13:22:54-05".
         If no timezone hour offset parameter is used, UTC time is assumed.
         */
+        int setCreatedAt(const char * createdAt);
+
         int setCreatedAt(String createdAt);
         
      
@@ -303,9 +460,37 @@
         
         Notes:
         Call setField(), setLatitude(), setLongitude(), setElevation() and/or setStatus() and then call writeFields()
+        Inside TS_RATE_LIMIT_MS after the last accepted write with this key nothing is sent, -401 comes right away
+        and the values are dropped, as ThingSpeak would do. beginWrite() holds such a write back instead.
         */
         int writeFields(unsigned long channelNumber, const char * writeAPIKey);
 
+
+        /*
+        Function: write
+        
+        Summary:
+        Write a fixed set of fields in one update, the field numbers are template arguments.
+        
+        Parameters:
+        fields - Field numbers (1-8) as template arguments, each at most once
+        channelNumber - Channel number
+        writeAPIKey - Write API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        values - One value for each field number, in the same order: int, long, float, double, const char * or String
+        
+        Returns:
+        The codes of writeFields(), except -210
+        -306 - Another request is in progress
+        
+        Notes:
+        Wrong field numbers and a wrong count of values don't compile. The keys of the body are put together by the compiler,
+        only the values are formatted when writing; floats with the precision set by setFieldPrecision().
+        Values set with setField() etc. are not part of this update and stay for the next writeFields().
+        ThingSpeak.write<1, 2, 3>(myChannelNumber, myWriteAPIKey, temperature, pressure, humidity);
+        */
+        template<unsigned int... fields, typename... Values>
+        int write(unsigned long channelNumber, const char * writeAPIKey, Values... values);
+
          
         /*
         Function: writeRaw
@@ -334,6 +519,75 @@
         This is low level functionality that will not be required by most users.
         */
         int writeRaw(unsigned long channelNumber, String postMessage, const char * writeAPIKey);
+
+
+        #ifndef ARDUINO_AVR_UNO // Arduino Uno doesn't have enough memory for the bulk buffer.
+
+            /*
+            Function: addBulkEntry
+
+            Summary:
+            Add the values set with setField(), setLatitude(), setLongitude(), setElevation() and setStatus() as one timestamped entry of a bulk update.
+
+            Parameters:
+            createdAt - Absolute timestamp of the entry in the ISO 8601 format. Example "2017-01-12 13:22:54"
+            deltaT - Relative timestamp of the entry in seconds, sent as delta_t as described in the ThingSpeak bulk-update documentation
+
+            Returns:
+            Code of 200 if successful.
+            Code of -102 if the entry doesn't fit into the bulk buffer (TS_BULK_BUFFER_SIZE bytes); the set values are kept
+            Code of -210 if setField() was not called before addBulkEntry()
+
+            Notes:
+            The set values are cleared once they are added. Twitter and tweet are not supported by bulk updates and are ignored.
+            Send the collected entries with writeBulk().
+            */
+            int addBulkEntry(String createdAt);
+
+            int addBulkEntry(unsigned long deltaT);
+
+
+            /*
+            Function: writeBulk
+
+            Summary:
+            Write all entries added with addBulkEntry() in one request to the bulk_update.json endpoint.
+
+            Parameters:
+            channelNumber - Channel number
+            writeAPIKey - Write API key associated with the channel.  *If you share code with others, do _not_ share this key*
+
+            Returns:
+            200 - successful (the server answers 202 Accepted).
+            -210 - addBulkEntry() was not called before writeBulk()
+            400 - writeAPIKey is NULL or empty, the bulk update has no default key
+            See writeFields() for the other possible return values.
+
+            Notes:
+            The entries are only cleared when the write succeeded, so a failed write can simply be repeated.
+            ThingSpeak limits bulk updates to one every 15 seconds, like single writes.
+            */
+            int writeBulk(unsigned long channelNumber, const char * writeAPIKey);
+
+
+            /*
+            Function: getBulkCount
+
+            Summary:
+            Number of entries waiting in the bulk buffer.
+            */
+            int getBulkCount();
+
+
+            /*
+            Function: clearBulk
+
+            Summary:
+            Drop all entries waiting in the bulk buffer.
+            */
+            void clearBulk();
+
+        #endif
         
          
         /*
@@ -625,22 +879,176 @@
         The read functions will return zero or empty if there is an error.  Use this function to retrieve the details.
         */
         int getLastReadStatus();
+
+
+        /*
+        Function: beginWrite
+
+        Summary:
+        Start writing the fields set with setField() etc. without waiting for the answer, see writeFields().
+
+        Parameters:
+        channelNumber - Channel number
+        writeAPIKey - Write API key associated with the channel, it is copied.
+        callback - Function called from poll() with the final status, NULL if not needed.
+
+        Returns:
+        200 - the request is on its way or held back, call poll() from loop() until the callback comes.
+        -306 - another request is still in progress.
+        The other codes of writeFields() if the request couldn't be sent; then there is no callback.
+
+        Notes:
+        The set values stay until the write is done, once it is sent setField() etc. return -306 until the callback.
+        Inside TS_RATE_LIMIT_MS after the last accepted write with this key the write is held back instead of sent:
+        setField() etc. still take values, the last one set wins, and calling beginWrite() again with the key only
+        replaces the callback. poll() sends it once the window is over. Reads, writeField() and writeRaw() go ahead meanwhile.
+        Opening a new connection still blocks inside the network client, a kept-alive connection avoids that.
+        */
+        int beginWrite(unsigned long channelNumber, const char * writeAPIKey, ThingSpeakCallback callback);
+
+        #ifndef ARDUINO_AVR_UNO
+            /*
+            Function: beginWriteBulk
+
+            Summary:
+            Start writing the entries added with addBulkEntry() without waiting for the answer, see writeBulk() and beginWrite().
+            addBulkEntry() returns -306 until the callback, on success the entries are cleared then.
+            Held back by the rate limit like beginWrite(), addBulkEntry() adds to it meanwhile.
+            */
+            int beginWriteBulk(unsigned long channelNumber, const char * writeAPIKey, ThingSpeakCallback callback);
+        #endif
+
+        /*
+        Function: beginRead
+
+        Summary:
+        Start reading the latest value of a field without waiting for the answer, see readStringField() and beginWrite().
+        The callback gets the value as response, cut to TS_RESPONSE_BUFFER_SIZE - 1 bytes. getLastReadStatus() is set too.
+        */
+        int beginRead(unsigned long channelNumber, unsigned int field, const char * readAPIKey, ThingSpeakCallback callback);
+
+        /*
+        Function: poll
+
+        Summary:
+        Move a request started with beginWrite(), beginWriteBulk() or beginRead() along, call it from loop().
+        It only takes what has arrived and never waits.
+
+        Returns:
+        true while a request is in progress or held back, false once it is done (the callback has been called then) or if there is none.
+        */
+        bool poll();
+
+
+        /*
+        Function: convertFloatToChar
+
+        Summary:
+        Format a float the way it is written to ThingSpeak.
+
+        Parameters:
+        value - Value to format, from -999999000000 to 999999000000, NaN or infinite.
+        valueString - Buffer for the text, at least 20 bytes.
+        decimals - Decimals right of the decimal point (0-5), halves are rounded away from zero and trailing zeros are left out.
+
+        Returns:
+        Code of 200 if successful.
+        Code of -101 if value or decimals is out of range
+
+        Notes:
+        Works with integers only, so it doesn't pull in the floating point printing of dtostrf() or sprintf().
+        */
+        static int convertFloatToChar(float value, char * valueString, unsigned int decimals = TS_FLOAT_DECIMALS);
         
         
     private:
             
-        int getWriteFieldsContentLength();
+        bool hasWriteValues();
         
         void emptyStream();
         
         int finishWrite();
-        
-        String getJSONValueByKey(String textToSearch, String key);
-        
+
+        int postFields(const char * writeAPIKey);
+
+        int serializeFields(char * body, size_t size);
+
+        int postRaw(const char * postMessage, size_t length, const char * writeAPIKey);
+
+        int writeBody(unsigned long channelNumber, const char * body, size_t length, const char * writeAPIKey);
+
+        template<unsigned int field, unsigned int... rest, typename Value, typename... Values>
+        int appendValues(char * & out, Value value, Values... values);
+
+        template<unsigned int... none>
+        int appendValues(char * & out);
+
+        int appendValue(char * & out, unsigned int field, int value);
+
+        int appendValue(char * & out, unsigned int field, long value);
+
+        int appendValue(char * & out, unsigned int field, float value);
+
+        int appendValue(char * & out, unsigned int field, double value);
+
+        int appendValue(char * & out, unsigned int field, const char * value);
+
+        int appendValue(char * & out, unsigned int field, const String & value);
+
+        String getRaw(const String & readURL, const char * readAPIKey);
+
+        bool requestRaw(const char * readURL, const char * readAPIKey, int & contentLength);
+
+        int postRead(const char * readURL, const char * readAPIKey);
+
+        int startWrite(unsigned long channelNumber, const char * writeAPIKey, ThingSpeakCallback callback, bool hold);
+
+        #ifndef ARDUINO_AVR_UNO
+            int startWriteBulk(unsigned long channelNumber, const char * writeAPIKey, ThingSpeakCallback callback, bool hold);
+        #endif
+
+        int beginRequest(uint8_t kind, unsigned long channelNumber, unsigned int field, const char * APIKey, ThingSpeakCallback callback, bool hold);
+
+        bool pollRequest();
+
+        void sendHeld();
+
+        int sendRequest();
+
+        int dispatchRequest();
+
+        bool isHeld(uint8_t kind, const char * APIKey);
+
+        static void copyKey(char * to, const char * APIKey);
+
+        unsigned long getRateLimitWait(uint32_t key);
+
+        void setRateLimitWrite(uint32_t key);
+
+        static uint32_t hashKey(const char * APIKey);
+
+        int waitForRequest();
+
+        int completeRequest(int status);
+
+        void startResponse();
+
+        int pollResponse();
+
+        int parseResponseLine();
+
+        void endRequest();
+
         #ifndef ARDUINO_AVR_UNO
-            String parseValues(String & multiContent, String key);
+            int appendBulkEntry(const char * timeKey, const char * timeValue, bool quoteTime);
+
+            bool appendBulk(const char * text, bool escape = false);
+
+            int postBulk(unsigned long channelNumber, const char * writeAPIKey);
         #endif
         
+        String getJSONValueByKey(String textToSearch, String key);
+        
         int abortWriteRaw();
 
         String abortReadRaw();
@@ -651,33 +1059,120 @@
         
         Client * client = NULL;
         unsigned int port = THINGSPEAK_PORT_NUMBER;
-        String nextWriteField[8];
+        bool keepAlive = false;         // the server left the connection open after the last response
+        bool reusedConnection = false;  // the current request went out on a kept-alive connection
+
+        // The request in progress, see beginWrite()
+        enum { REQUEST_NONE, REQUEST_WRITE, REQUEST_BULK, REQUEST_READ };
+        uint8_t requestKind = REQUEST_NONE;
+        bool requestRetried = false;    // the one extra send after a closed connection is used up
+        unsigned long requestChannel = 0;
+        unsigned int requestField = 0;
+        char requestKey[TS_API_KEY_LENGTH + 1] = "";  // empty for none
+        uint32_t requestKeyHash = 0;
+        ThingSpeakCallback requestCallback = NULL;
+        int requestStatus = TS_OK_SUCCESS;
+        char response[TS_RESPONSE_BUFFER_SIZE];
+
+        // A write or bulk update that beginWrite() holds back until the rate limit allows it, see sendHeld()
+        uint8_t heldKind = REQUEST_NONE;
+        unsigned long heldChannel = 0;
+        char heldKey[TS_API_KEY_LENGTH + 1] = "";
+        uint32_t heldKeyHash = 0;
+        ThingSpeakCallback heldCallback = NULL;
+
+        // Last accepted write per write API key, ThingSpeak finds the channel of a write by its key.
+        // Shared by all instances, two of them writing with the same key share its window.
+        struct RateLimitEntry {
+            uint32_t key;               // hash of the key, 0 if unused
+            unsigned long acceptedAt;
+        };
+        static RateLimitEntry rateLimit[TS_RATE_LIMIT_KEYS];
+
+        // The response read so far, taken apart line by line until the body
+        enum { RESPONSE_STATUS_LINE, RESPONSE_HEADERS, RESPONSE_BODY };
+        static const int RESPONSE_PENDING = 0;
+        uint8_t responseState = RESPONSE_STATUS_LINE;
+        char responseLine[48];          // long enough for the headers we look at
+        uint8_t responseLineLength = 0;
+        int responseStatus = 0;
+        int responseContentLength = -1;
+        bool responsePersistent = false;
+        bool responseStarted = false;
+        unsigned long responseDeadline = 0;
+        // Slots of the text values in writeBuffer, the fields come first
+        enum { WRITE_STATUS = FIELDNUM_MAX, WRITE_TWITTER, WRITE_TWEET, WRITE_CREATED_AT, WRITE_SLOTS };
+        char writeBuffer[TS_WRITE_BUFFER_SIZE];  // values with their terminators, empty values take no room
+        uint16_t writeStart[WRITE_SLOTS];
+        uint16_t writeLength[WRITE_SLOTS];
+        size_t writeUsed = 0;
         float nextWriteLatitude;
         float nextWriteLongitude;
         float nextWriteElevation;
+        uint8_t fieldDecimals[FIELDNUM_MAX];
         int lastReadStatus;
-        String nextWriteStatus;
-        String nextWriteTwitter;
-        String nextWriteTweet;
-        String nextWriteCreatedAt;
         #ifndef ARDUINO_AVR_UNO
             feed lastFeed;
+            char bulkBuffer[TS_BULK_BUFFER_SIZE];  // entries as JSON objects separated by commas
+            size_t bulkLength = 0;
+            int bulkCount = 0;
         #endif
 
         bool connectThingSpeak();
 
-        bool writeHTTPHeader(const char * APIKey);
-
-        int getHTTPResponse(String & response);
-        
+        int getHTTPResponse(int & contentLength);
         
-        int convertFloatToChar(float value, char *valueString);
-
         float convertStringToFloat(String value);
 
+        unsigned int getFieldDecimals(unsigned int field);
+
         void resetWriteFields();
+
+        int setWriteValue(size_t slot, const char * value, size_t length);
+
+        void clearWriteValue(size_t slot);
+
+        const char * getWriteValue(size_t slot);
     };
 
+template<unsigned int... fields, typename... Values>
+int ThingSpeakClass::write(unsigned long channelNumber, const char * writeAPIKey, Values... values) {
+    static_assert(sizeof...(fields) > 0, "write<>() needs at least one field number");
+    static_assert(sizeof...(fields) == sizeof...(Values), "write<>() needs one value for each field number");
+    static_assert(TSFieldList<fields...>::inRange, "Field numbers of write<>() are 1 to 8");
+    static_assert(TSFieldList<fields...>::distinct, "A field number of write<>() is repeated");
+
+    if(this->requestKind != REQUEST_NONE) return TS_ERR_BUSY;
+
+    char body[TSBodySize<Values...>::value];
+    char * out = body;
+    int status = appendValues<fields...>(out, values...);
+    if(status != TS_OK_SUCCESS) return status;
+
+    memcpy(out, "&headers=false", 14);
+    out += 14;
+
+    // Every key comes with its '&', the body starts behind the first one
+    return writeBody(channelNumber, body + 1, out - body - 1, writeAPIKey);
+}
+
+template<unsigned int field, unsigned int... rest, typename Value, typename... Values>
+int ThingSpeakClass::appendValues(char * & out, Value value, Values... values) {
+    memcpy(out, TSFieldKey<field>::text, sizeof(TSFieldKey<field>::text) - 1);
+    out += sizeof(TSFieldKey<field>::text) - 1;
+
+    int status = appendValue(out, field, value);
+    if(status != TS_OK_SUCCESS) return status;
+
+    return appendValues<rest...>(out, values...);
+}
+
+template<unsigned int... none>
+int ThingSpeakClass::appendValues(char * &) {
+    return TS_OK_SUCCESS;
+}
+
+// The instance most sketches use, defined in ThingSpeakInstance.cpp and only linked in when it is used
 extern ThingSpeakClass ThingSpeak;
 
 #endif //ThingSpeak_h
@@ -0,0 +1,12 @@
+/*
+  ThingSpeak Communication Library For Arduino, ESP8266 and ESP32
+  
+  The global ThingSpeak instance. It lives in its own file so that sketches which create
+  their own ThingSpeakClass instances don't pay for it (see dot_a_linkage in library.properties).
+  
+  See the accompaning licence file for licensing information.
+*/
+
+#include "ThingSpeak.h"
+
+ThingSpeakClass ThingSpeak;